@@ -0,0 +1,219 @@
+#include "bench.h"
+#include "bitboard.h"
+#include "eval.h"
+#include "perft.h"
+#include "search.h"
+#include "tt.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace Bench {
+
+const std::vector<std::string> POSITIONS = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1QBPPP/R3KB1R w KQ - 0 9",
+    "2r3k1/pp3ppp/4p3/3pP3/3P1P2/1P6/P5PP/2R3K1 b - - 0 25",
+};
+
+const std::vector<std::string> TACTICAL_POSITIONS = {
+    "2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1",
+    "8/7p/5k2/5p2/p1p2P2/Pr1pPK2/1P1R3P/8 b - - 0 1",
+    "5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RK1 b - - 0 1",
+    "r1bq2rk/pp3pbp/2p1p1pQ/7P/3P4/2PB1N2/PP3PP1/R3KR2 w Q - 0 1",
+    "5k2/6pp/p1qN4/1p1p4/3P4/2PKP2Q/PP3r2/8 b - - 0 1",
+    "7k/p7/1R5K/6r1/6p1/6P1/8/8 w - - 0 1",
+    "rnbqkb1r/pppp1ppp/8/4P3/6n1/7P/PPPNPPP1/R1BQKBNR b KQkq - 0 1",
+    "r4q1k/p2bR1rp/2p2Q1N/5p2/5p2/2P5/PP3PPP/R5K1 w - - 0 1",
+};
+
+void run_slider_bench() {
+    const int SAMPLES = 1 << 16;
+    const int ROUNDS = 64;
+    
+    // Random squares and sparse random occupancies, generated once so every
+    // backend looks up exactly the same inputs
+    std::vector<Square> squares(SAMPLES);
+    std::vector<Bitboard> occupancies(SAMPLES);
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < SAMPLES; i++) {
+        seed ^= seed >> 12; seed ^= seed << 25; seed ^= seed >> 27;
+        uint64_t r = seed * 2685821657736338717ULL;
+        squares[i] = Square(r & 63);
+        occupancies[i] = r & (r >> 7) & (r >> 13);
+    }
+    
+    SliderBackend selected = slider_backend;
+    const SliderBackend backends[] = { SLIDER_MAGIC, SLIDER_PEXT };
+    
+    for (SliderBackend backend : backends) {
+        if (!BitboardUtils::set_slider_backend(backend)) {
+            std::cout << "  " << BitboardUtils::slider_backend_name(backend) << ": not supported on this CPU\n";
+            continue;
+        }
+        
+        Bitboard checksum = 0;
+        auto start_time = std::chrono::steady_clock::now();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int i = 0; i < SAMPLES; i++) {
+                checksum ^= bishop_attacks(squares[i], occupancies[i]) ^ rook_attacks(squares[i], occupancies[i] ^ checksum);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        
+        double lookups = 2.0 * SAMPLES * ROUNDS;
+        std::cout << "  " << BitboardUtils::slider_backend_name(backend) << ": "
+                  << lookups / seconds / 1e6 << " M lookups/s"
+                  << " (" << seconds * 1e9 / lookups << " ns/lookup, checksum " << (checksum & 0xFFFF) << ")\n";
+    }
+    
+    BitboardUtils::set_slider_backend(selected);
+}
+
+void run_movegen_bench() {
+    const int ITERATIONS = 20000;
+    
+    double total_gen_ns = 0, total_eval_ns = 0;
+    for (const std::string& fen : POSITIONS) {
+        Board board(fen);
+        size_t checksum = 0;
+        
+        auto start_time = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            MoveList moves;
+            board.generate_pseudo_legal_moves(moves);
+            checksum += moves.size();
+        }
+        auto mid_time = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            checksum += Eval::evaluate(board);
+        }
+        auto end_time = std::chrono::steady_clock::now();
+        
+        double gen_ns = std::chrono::duration<double, std::nano>(mid_time - start_time).count() / ITERATIONS;
+        double eval_ns = std::chrono::duration<double, std::nano>(end_time - mid_time).count() / ITERATIONS;
+        total_gen_ns += gen_ns;
+        total_eval_ns += eval_ns;
+        std::cout << "  movegen " << gen_ns << " ns, eval " << eval_ns << " ns  (" << fen << ", checksum " << checksum << ")\n";
+    }
+    
+    std::cout << "  average: movegen " << total_gen_ns / POSITIONS.size() << " ns/position, eval "
+              << total_eval_ns / POSITIONS.size() << " ns/position\n";
+}
+
+void run_perft_bench() {
+    const int DEPTH = 5;
+    const size_t HASH_MB = 64;
+    Board board(POSITIONS[1]); // Kiwipete
+    
+    int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+    
+    double single_thread_seconds = 0;
+    for (int threads : thread_counts) {
+        auto start_time = std::chrono::steady_clock::now();
+        uint64_t nodes = Perft::parallel_perft(board, DEPTH, threads, 0);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        if (threads == 1) single_thread_seconds = seconds;
+        
+        std::cout << "  " << threads << " thread(s): " << nodes << " nodes, " << nodes / seconds / 1e6
+                  << " M nodes/s, speedup " << single_thread_seconds / seconds << "x\n";
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    uint64_t nodes = Perft::parallel_perft(board, DEPTH, max_threads, HASH_MB);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "  " << max_threads << " thread(s) + " << HASH_MB << "MB hash: " << nodes << " nodes, "
+              << seconds * 1000 << " ms, speedup " << single_thread_seconds / seconds << "x\n";
+}
+
+void run_search_bench() {
+    Search::SearchParams params;
+    params.max_depth = 5;
+    params.max_time_ms = 60000;
+    
+    uint64_t total_nodes = 0;
+    double total_seconds = 0;
+    double total_ebf = 0;
+    for (const std::string& fen : TACTICAL_POSITIONS) {
+        // Each position starts from an empty table so runs are repeatable
+        Board board(fen);
+        TT.clear();
+        auto start_time = std::chrono::steady_clock::now();
+        Search::SearchResult result = Search::search(board, params);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        
+        total_nodes += result.nodes_searched;
+        total_seconds += seconds;
+        total_ebf += result.ebf;
+        std::cout << "  " << result.best_move.to_string() << "  " << result.nodes_searched << " nodes, ebf "
+                  << result.ebf << ", " << seconds * 1000 << " ms  (" << fen << ")\n";
+    }
+    
+    std::cout << "  total: " << total_nodes << " nodes, " << total_seconds * 1000 << " ms, "
+              << total_nodes / total_seconds / 1e6 << " M nodes/s, average ebf "
+              << total_ebf / TACTICAL_POSITIONS.size() << "\n";
+}
+
+void run_smp_bench() {
+    const int DEPTH = 6;
+    
+    int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+    
+    double single_thread_seconds = 0;
+    for (int threads : thread_counts) {
+        Search::SearchParams params;
+        params.max_depth = DEPTH;
+        params.max_time_ms = 600000;
+        params.threads = threads;
+        
+        // Every thread count starts each position from an empty table
+        uint64_t total_nodes = 0;
+        double total_seconds = 0;
+        for (const std::string& fen : TACTICAL_POSITIONS) {
+            Board board(fen);
+            TT.clear();
+            auto start_time = std::chrono::steady_clock::now();
+            Search::SearchResult result = Search::search(board, params);
+            total_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            total_nodes += result.nodes_searched;
+        }
+        if (threads == 1) single_thread_seconds = total_seconds;
+        
+        std::cout << "  " << threads << " thread(s): " << total_seconds * 1000 << " ms to depth " << DEPTH
+                  << ", " << total_nodes / total_seconds / 1e6 << " M nodes/s, time-to-depth speedup "
+                  << single_thread_seconds / total_seconds << "x\n";
+    }
+}
+
+void run() {
+    std::cout << "Slider backend: " << BitboardUtils::slider_backend_name(slider_backend) << "\n";
+    std::cout << "Slider attack lookups:\n";
+    run_slider_bench();
+    std::cout << "Move generation and evaluation:\n";
+    run_movegen_bench();
+    std::cout << "Search (tactical positions, depth 5):\n";
+    run_search_bench();
+    std::cout << "Lazy SMP search (tactical positions, depth 6):\n";
+    run_smp_bench();
+    std::cout << "Perft (Kiwipete, depth 5):\n";
+    run_perft_bench();
+}
+
+} // namespace Bench
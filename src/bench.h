@@ -0,0 +1,31 @@
+#pragma once
+#include "board.h"
+#include <string>
+#include <vector>
+
+namespace Bench {
+    // Standard benchmark positions (FEN)
+    extern const std::vector<std::string> POSITIONS;
+    
+    // Tactical positions (Win At Chess), where quiescence dominates the search
+    extern const std::vector<std::string> TACTICAL_POSITIONS;
+    
+    // Slider attack lookup throughput for every backend the host supports
+    void run_slider_bench();
+    
+    // Per-position cost of move generation and static evaluation
+    void run_movegen_bench();
+    
+    // Parallel perft speed and speedup for each thread count up to the core count
+    void run_perft_bench();
+    
+    // Fixed-depth search speed on the tactical positions
+    void run_search_bench();
+    
+    // Lazy SMP time to depth and node rate for each thread count up to the
+    // core count
+    void run_smp_bench();
+    
+    // Run all benchmarks and print the results
+    void run();
+}
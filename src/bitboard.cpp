@@ -1,185 +1,168 @@
 #include "bitboard.h"
 #include <cstring>
 #include <stdexcept>
-
-// Global lookup tables
-Bitboard FILE_BB[8];
-Bitboard RANK_BB[8];
-Bitboard SQUARE_BB[64];
-Bitboard RAYS[8][64];
-Bitboard PAWN_ATTACKS[2][64];
-Bitboard KNIGHT_ATTACKS[64];
-Bitboard KING_ATTACKS[64];
-// Magic bitboard arrays (deprecated - using step-by-step approach)
-// Bitboard BISHOP_ATTACKS[64][512];
-// Bitboard ROOK_ATTACKS[64][4096];
-// Bitboard BISHOP_MAGIC[64];
-// Bitboard ROOK_MAGIC[64];
-
-// Magic numbers for sliding piece move generation (deprecated - using step-by-step approach)
-// static const Bitboard BishopMagicNumbers[64] = { ... };
-// static const Bitboard RookMagicNumbers[64] = { ... };
-
-namespace BitboardUtils {
-
-void init() {
-    // Initialize square bitboards
-    for (int sq = 0; sq < 64; sq++) {
-        SQUARE_BB[sq] = 1ULL << sq;
-    }
-    
-    // Initialize file and rank bitboards
-    for (int f = 0; f < 8; f++) {
-        FILE_BB[f] = 0x0101010101010101ULL << f;
-    }
-    for (int r = 0; r < 8; r++) {
-        RANK_BB[r] = 0xFFULL << (r * 8);
-    }
-    
-    // Initialize rays for sliding pieces
-    for (int sq = 0; sq < 64; sq++) {
-        int file = file_of(Square(sq));
-        int rank = rank_of(Square(sq));
-        
-        // Initialize all rays to empty
-        for (int dir = 0; dir < 8; dir++) {
-            RAYS[dir][sq] = 0;
-        }
-        
-        // North
-        for (int r = rank + 1; r < 8; r++) {
-            set_bit(RAYS[0][sq], make_square(File(file), Rank(r)));
-        }
-        
-        // South
-        for (int r = rank - 1; r >= 0; r--) {
-            set_bit(RAYS[1][sq], make_square(File(file), Rank(r)));
-        }
-        
-        // East
-        for (int f = file + 1; f < 8; f++) {
-            set_bit(RAYS[2][sq], make_square(File(f), Rank(rank)));
-        }
-        
-        // West
-        for (int f = file - 1; f >= 0; f--) {
-            set_bit(RAYS[3][sq], make_square(File(f), Rank(rank)));
-        }
-        
-        // Northeast, Northwest, Southeast, Southwest
-        for (int i = 1; i < 8; i++) {
-            if (file + i < 8 && rank + i < 8) {
-                set_bit(RAYS[4][sq], make_square(File(file + i), Rank(rank + i)));
-            }
-            if (file - i >= 0 && rank + i < 8) {
-                set_bit(RAYS[5][sq], make_square(File(file - i), Rank(rank + i)));
-            }
-            if (file + i < 8 && rank - i >= 0) {
-                set_bit(RAYS[6][sq], make_square(File(file + i), Rank(rank - i)));
-            }
-            if (file - i >= 0 && rank - i >= 0) {
-                set_bit(RAYS[7][sq], make_square(File(file - i), Rank(rank - i)));
-            }
-        }
-    }
+#if CHESS_HAS_PEXT
+#include <cpuid.h>
+#endif
+
+// Magic numbers for sliding piece move generation. Each one maps every subset
+// of the square's relevant occupancy mask onto a unique (or constructively
+// colliding) slot when shifted by 64 - popcount(mask).
+static const Bitboard BishopMagicNumbers[64] = {
+    0x2008021012002502ULL, 0x04d0100110628400ULL, 0x21102080a1021010ULL, 0x2044041080000400ULL,
+    0x0004050402800000ULL, 0x0002010420109560ULL, 0x08040084500a0000ULL, 0x9401002104224008ULL,
+    0x40044350070b0100ULL, 0x90b00888088c1040ULL, 0x0100100440444012ULL, 0x80001104008a0940ULL,
+    0x1042920210504048ULL, 0x0000010420048200ULL, 0x000000a410221000ULL, 0x804800829c901001ULL,
+    0x0040002008010120ULL, 0x8802008424280205ULL, 0x200800010a040010ULL, 0x2420800802004008ULL,
+    0x0012011402a21220ULL, 0x2002028508022208ULL, 0x0486200049100802ULL, 0x2000211101080200ULL,
+    0x8020200044140c60ULL, 0x0810680c05080381ULL, 0x0001442028012400ULL, 0x4028088008020002ULL,
+    0x25c1001041004010ULL, 0x0401020049080140ULL, 0x0004004084210400ULL, 0x40010900104400a0ULL,
+    0x011011480004a800ULL, 0x0082020200a0680bULL, 0x0800203000080082ULL, 0x0005020081880080ULL,
+    0x1050120080001004ULL, 0x0020008880030810ULL, 0x2241180900008c30ULL, 0x0201451101012400ULL,
+    0x8444016008025000ULL, 0x0002080104000800ULL, 0x2801001490090200ULL, 0x0500142018001100ULL,
+    0x0300040408200400ULL, 0x0008008800820810ULL, 0x0804210204004212ULL, 0x000800a698800202ULL,
+    0x0411040202401000ULL, 0x0a008c051802000eULL, 0x1002a100a8040022ULL, 0x00000c0084042600ULL,
+    0x1000884048220000ULL, 0x0082200410208000ULL, 0x0222020441140022ULL, 0x1004080800408810ULL,
+    0x0022410801500201ULL, 0x010000410818020bULL, 0x2044000044040410ULL, 0x00200c0100208801ULL,
+    0x080800200a102400ULL, 0x000404c010020090ULL, 0x1002101418808c03ULL, 0x0011300081040020ULL
+};
+
+static const Bitboard RookMagicNumbers[64] = {
+    0xa680042040001480ULL, 0x40c0014010002000ULL, 0x0200100820804202ULL, 0x0900100008210004ULL,
+    0x4a00108402000820ULL, 0x2200040200018810ULL, 0x03000100220008acULL, 0x4080002044800d00ULL,
+    0x008c800080400820ULL, 0x400240012002d000ULL, 0x0001001041002008ULL, 0x0110801000080080ULL,
+    0x0001000500100800ULL, 0x8a46000408020010ULL, 0x00040010084104a2ULL, 0x014a000220804401ULL,
+    0x80102a8000400088ULL, 0x0020008020804000ULL, 0x4010008010200081ULL, 0x0208010100100020ULL,
+    0x2091010008001005ULL, 0x0002008080020400ULL, 0x240024001110c208ULL, 0x0400120001008054ULL,
+    0x8080208080004004ULL, 0x80dd5004c0042000ULL, 0x0410040120080120ULL, 0x2000d00180380080ULL,
+    0x0008000880040080ULL, 0x100a000200080410ULL, 0x0300080400100102ULL, 0x6200008200011044ULL,
+    0x061481400c800060ULL, 0x1001004001002084ULL, 0x0000200080801000ULL, 0x840010010100200bULL,
+    0x0028040080800800ULL, 0x0882000406001830ULL, 0x0001005421001200ULL, 0x000001804600010cULL,
+    0x0000804000208000ULL, 0x4400402010044000ULL, 0x4010008020028014ULL, 0x0000090410010020ULL,
+    0x0000080100110005ULL, 0x0a00201004080140ULL, 0x0000040200010100ULL, 0x0220007081020004ULL,
+    0x840205c981002a00ULL, 0x0000804000200480ULL, 0x0002081040802200ULL, 0x0240230010000900ULL,
+    0x0044800800240180ULL, 0x4011000400080300ULL, 0x00101011088a0c00ULL, 0x1003000080420100ULL,
+    0x0180102100408001ULL, 0x1100108040010021ULL, 0x0182004008108022ULL, 0x0122900128202501ULL,
+    0x0002012004100802ULL, 0x00c200834c081002ULL, 0x0440020110083084ULL, 0x4000484884010022ULL
+};
+
+// Slider attacks from the ray tables: each ray is cut at its first blocker,
+// found with a bit scan towards or away from the slider. 'rays' holds the
+// square's eight RAYS entries.
+static constexpr Bitboard ray_attacks(Piece piece, const Bitboard rays[8], Bitboard occupied) {
+    Bitboard attacks = 0;
+    int first = (piece == BISHOP) ? 4 : 0;
+    int last = (piece == ROOK) ? 4 : 8;
     
-    // Initialize pawn attack tables
-    for (int sq = 0; sq < 64; sq++) {
-        int file = file_of(Square(sq));
-        int rank = rank_of(Square(sq));
-        
-        // White pawn attacks (captures to the left and right)
-        if (rank < 7) {
-            if (file > 0) set_bit(PAWN_ATTACKS[WHITE][sq], make_square(File(file - 1), Rank(rank + 1)));
-            if (file < 7) set_bit(PAWN_ATTACKS[WHITE][sq], make_square(File(file + 1), Rank(rank + 1)));
+    for (int dir = first; dir < last; dir++) {
+        Bitboard blockers = rays[dir] & occupied;
+        if (!blockers) {
+            attacks |= rays[dir];
+            continue;
         }
         
-        // Black pawn attacks (captures to the left and right)
-        if (rank > 0) {
-            if (file > 0) set_bit(PAWN_ATTACKS[BLACK][sq], make_square(File(file - 1), Rank(rank - 1)));
-            if (file < 7) set_bit(PAWN_ATTACKS[BLACK][sq], make_square(File(file + 1), Rank(rank - 1)));
-        }
+        // N, E, NE and NW step towards higher squares
+        bool ascending = (dir == 0 || dir == 2 || dir == 4 || dir == 5);
+        Square blocker = ascending ? BitboardUtils::lsb(blockers) : BitboardUtils::msb(blockers);
+        attacks |= rays[dir] ^ RAYS[dir][blocker];
     }
+    return attacks;
+}
+
+// Magic entries for one slider type, packing each square's slots back to
+// back in the shared attack tables
+static constexpr std::array<Magic, 64> make_magics(Piece piece, const Bitboard magic_numbers[]) {
+    std::array<Magic, 64> magics{};
+    unsigned offset = 0;
     
-    // Initialize knight attack table
     for (int sq = 0; sq < 64; sq++) {
-        int file = file_of(Square(sq));
-        int rank = rank_of(Square(sq));
+        const Bitboard rays[8] = { RAYS[0][sq], RAYS[1][sq], RAYS[2][sq], RAYS[3][sq],
+                                   RAYS[4][sq], RAYS[5][sq], RAYS[6][sq], RAYS[7][sq] };
         
-        const int knight_dx[] = {-2, -2, -1, -1, 1, 1, 2, 2};
-        const int knight_dy[] = {-1, 1, -2, 2, -2, 2, -1, 1};
+        // Board edges are irrelevant unless the slider stands on them
+        Bitboard edges = ((RANK_BB[RANK_1] | RANK_BB[RANK_8]) & ~RANK_BB[sq >> 3]) |
+                         ((FILE_BB[FILE_A] | FILE_BB[FILE_H]) & ~FILE_BB[sq & 7]);
         
-        for (int i = 0; i < 8; i++) {
-            int new_file = file + knight_dx[i];
-            int new_rank = rank + knight_dy[i];
-            if (new_file >= 0 && new_file < 8 && new_rank >= 0 && new_rank < 8) {
-                set_bit(KNIGHT_ATTACKS[sq], make_square(File(new_file), Rank(new_rank)));
-            }
-        }
+        Magic& m = magics[sq];
+        m.mask = ray_attacks(piece, rays, 0) & ~edges;
+        m.magic = magic_numbers[sq];
+        m.shift = 64 - BitboardUtils::popcount(m.mask);
+        m.offset = offset;
+        offset += 1u << (64 - m.shift);
     }
+    return magics;
+}
+
+// Attack tables for both backends, one row per SliderBackend. Carry-Rippler
+// enumerates the subsets of a mask in increasing PEXT order, so the PEXT
+// slot is just a counter.
+template <size_t Size>
+static constexpr std::array<std::array<Bitboard, Size>, 2> make_slider_attacks(Piece piece, const std::array<Magic, 64>& magics) {
+    std::array<std::array<Bitboard, Size>, 2> attacks{};
     
-    // Initialize king attack table
     for (int sq = 0; sq < 64; sq++) {
-        int file = file_of(Square(sq));
-        int rank = rank_of(Square(sq));
+        const Bitboard rays[8] = { RAYS[0][sq], RAYS[1][sq], RAYS[2][sq], RAYS[3][sq],
+                                   RAYS[4][sq], RAYS[5][sq], RAYS[6][sq], RAYS[7][sq] };
+        const Magic m = magics[sq];
+        Bitboard* magic_row = attacks[SLIDER_MAGIC].data() + m.offset;
+        Bitboard* pext_row = attacks[SLIDER_PEXT].data() + m.offset;
         
-        for (int df = -1; df <= 1; df++) {
-            for (int dr = -1; dr <= 1; dr++) {
-                if (df == 0 && dr == 0) continue;
-                int new_file = file + df;
-                int new_rank = rank + dr;
-                if (new_file >= 0 && new_file < 8 && new_rank >= 0 && new_rank < 8) {
-                    set_bit(KING_ATTACKS[sq], make_square(File(new_file), Rank(new_rank)));
-                }
-            }
-        }
+        Bitboard occupied = 0;
+        do {
+            Bitboard bb = ray_attacks(piece, rays, occupied);
+            magic_row[(occupied * m.magic) >> m.shift] = bb;
+            *pext_row++ = bb;
+            occupied = (occupied - m.mask) & m.mask;
+        } while (occupied);
     }
-    
-    // Magic number initialization (deprecated - using step-by-step approach)
-    // for (int i = 0; i < 64; i++) {
-    //     BISHOP_MAGIC[i] = BishopMagicNumbers[i];
-    //     ROOK_MAGIC[i] = RookMagicNumbers[i];
-    // }
-    
-    // Sliding piece attack table initialization (deprecated - using step-by-step approach)
-    // for (int sq = 0; sq < 64; sq++) {
-    //     // Bishop attacks initialization code...
-    //     // Rook attacks initialization code...
-    // }
+    return attacks;
 }
 
-int popcount(Bitboard bb) {
-    return __builtin_popcountll(bb);
-}
-
-int lsb(Bitboard bb) {
-    return __builtin_ctzll(bb);
-}
+constexpr std::array<Magic, 64> BISHOP_MAGICS = make_magics(BISHOP, BishopMagicNumbers);
+constexpr std::array<Magic, 64> ROOK_MAGICS = make_magics(ROOK, RookMagicNumbers);
+constexpr std::array<std::array<Bitboard, 0x1480>, 2> BISHOP_ATTACKS = make_slider_attacks<0x1480>(BISHOP, BISHOP_MAGICS);
+constexpr std::array<std::array<Bitboard, 0x19000>, 2> ROOK_ATTACKS = make_slider_attacks<0x19000>(ROOK, ROOK_MAGICS);
 
-int msb(Bitboard bb) {
-    return 63 - __builtin_clzll(bb);
-}
+static_assert(BISHOP_MAGICS[63].offset + (1u << (64 - BISHOP_MAGICS[63].shift)) == 0x1480, "bishop table size");
+static_assert(ROOK_MAGICS[63].offset + (1u << (64 - ROOK_MAGICS[63].shift)) == 0x19000, "rook table size");
 
-Bitboard pop_lsb(Bitboard& bb) {
-    Bitboard result = bb & -bb;
-    bb &= bb - 1;
-    return result;
-}
+SliderBackend slider_backend = BitboardUtils::cpu_has_fast_pext() ? SLIDER_PEXT : SLIDER_MAGIC;
 
-Square make_square(File file, Rank rank) {
-    return Square(rank * 8 + file);
-}
+namespace BitboardUtils {
 
-File file_of(Square sq) {
-    return File(sq & 7);
+bool cpu_has_fast_pext() {
+#if CHESS_HAS_PEXT
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) || !(ebx & (1u << 8))) {
+        return false; // No BMI2
+    }
+    
+    // AMD before Zen 3 (family 19h) implements PEXT in microcode, which is
+    // far slower than a magic multiply
+    __get_cpuid(0, &eax, &ebx, &ecx, &edx);
+    bool amd = (ebx == 0x68747541 && edx == 0x69746e65 && ecx == 0x444d4163); // "AuthenticAMD"
+    if (amd) {
+        __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+        unsigned family = (eax >> 8) & 0xF;
+        if (family == 0xF) family += (eax >> 20) & 0xFF;
+        return family >= 0x19;
+    }
+    return true;
+#else
+    return false;
+#endif
 }
 
-Rank rank_of(Square sq) {
-    return Rank(sq >> 3);
+bool set_slider_backend(SliderBackend backend) {
+    if (backend == SLIDER_PEXT && !cpu_has_fast_pext()) {
+        return false;
+    }
+    slider_backend = backend;
+    return true;
 }
 
-Square relative_square(Color c, Square sq) {
-    return c == WHITE ? sq : Square(sq ^ 56);
+const char* slider_backend_name(SliderBackend backend) {
+    return backend == SLIDER_PEXT ? "pext (BMI2)" : "magic";
 }
 
 std::string square_to_string(Square sq) {
@@ -197,149 +180,65 @@ Square string_to_square(const std::string& str) {
     return make_square(File(file), Rank(rank));
 }
 
-bool is_attacked(Square sq, Color by_color, const Bitboard pieces[2][6]) {
-    Bitboard occupied = pieces[WHITE][0] | pieces[WHITE][1] | pieces[WHITE][2] | 
-                       pieces[WHITE][3] | pieces[WHITE][4] | pieces[WHITE][5] |
-                       pieces[BLACK][0] | pieces[BLACK][1] | pieces[BLACK][2] | 
-                       pieces[BLACK][3] | pieces[BLACK][4] | pieces[BLACK][5];
-    
-    // Check pawn attacks
-    if (PAWN_ATTACKS[!by_color][sq] & pieces[by_color][PAWN]) return true;
-    
-    // Check knight attacks
-    if (KNIGHT_ATTACKS[sq] & pieces[by_color][KNIGHT]) return true;
-    
-    // Check bishop attacks using step-by-step approach
-    Bitboard bishops = pieces[by_color][BISHOP];
-    while (bishops) {
-        Bitboard bishop = pop_lsb(bishops);
-        Square from = Square(lsb(bishop));
-        if (get_attacks(BISHOP, from, by_color, occupied) & square_bb(sq)) {
-            return true;
-        }
-    }
-    
-    // Check rook attacks using step-by-step approach
-    Bitboard rooks = pieces[by_color][ROOK];
-    while (rooks) {
-        Bitboard rook = pop_lsb(rooks);
-        Square from = Square(lsb(rook));
-        if (get_attacks(ROOK, from, by_color, occupied) & square_bb(sq)) {
-            return true;
-        }
-    }
+Bitboard sliding_attacks(Piece piece, Square sq, Bitboard occupied) {
+    Bitboard attacks = 0;
+    int file = file_of(sq);
+    int rank = rank_of(sq);
     
-    // Check queen attacks using step-by-step approach
-    Bitboard queens = pieces[by_color][QUEEN];
-    while (queens) {
-        Bitboard queen = pop_lsb(queens);
-        Square from = Square(lsb(queen));
-        if (get_attacks(QUEEN, from, by_color, occupied) & square_bb(sq)) {
-            return true;
-        }
-    }
+    // Diagonal directions first, then orthogonal ones
+    const int slider_dx[] = {-1, -1, 1, 1, -1, 1, 0, 0};
+    const int slider_dy[] = {-1, 1, -1, 1, 0, 0, -1, 1};
     
-    // Check king attacks
-    if (KING_ATTACKS[sq] & pieces[by_color][KING]) return true;
+    int first = (piece == ROOK) ? 4 : 0;
+    int last = (piece == BISHOP) ? 4 : 8;
     
-    return false;
-}
-
-Bitboard get_attacks(Piece piece, Square sq, Color color, Bitboard occupied) {
-    switch (piece) {
-        case PAWN:
-            return PAWN_ATTACKS[color][sq];
-        case KNIGHT:
-            return KNIGHT_ATTACKS[sq];
-        case BISHOP: {
-            Bitboard attacks = 0;
-            int file = file_of(sq);
-            int rank = rank_of(sq);
-            
-            // Check all four diagonal directions
-            const int bishop_dx[] = {-1, -1, 1, 1};
-            const int bishop_dy[] = {-1, 1, -1, 1};
+    for (int i = first; i < last; i++) {
+        int new_file = file + slider_dx[i];
+        int new_rank = rank + slider_dy[i];
+        
+        while (new_file >= 0 && new_file < 8 && new_rank >= 0 && new_rank < 8) {
+            Square target = make_square(File(new_file), Rank(new_rank));
+            set_bit(attacks, target);
             
-            for (int i = 0; i < 4; i++) {
-                int new_file = file + bishop_dx[i];
-                int new_rank = rank + bishop_dy[i];
-                
-                while (new_file >= 0 && new_file < 8 && new_rank >= 0 && new_rank < 8) {
-                    Square target = make_square(File(new_file), Rank(new_rank));
-                    set_bit(attacks, target);
-                    
-                    // If this square is occupied, stop
-                    if (test_bit(occupied, target)) {
-                        break;
-                    }
-                    
-                    new_file += bishop_dx[i];
-                    new_rank += bishop_dy[i];
-                }
+            // If this square is occupied, stop
+            if (test_bit(occupied, target)) {
+                break;
             }
-            return attacks;
-        }
-        case ROOK: {
-            Bitboard attacks = 0;
-            int file = file_of(sq);
-            int rank = rank_of(sq);
             
-            // Check all four orthogonal directions
-            const int rook_dx[] = {-1, 1, 0, 0};
-            const int rook_dy[] = {0, 0, -1, 1};
-            
-            for (int i = 0; i < 4; i++) {
-                int new_file = file + rook_dx[i];
-                int new_rank = rank + rook_dy[i];
-                
-                while (new_file >= 0 && new_file < 8 && new_rank >= 0 && new_rank < 8) {
-                    Square target = make_square(File(new_file), Rank(new_rank));
-                    set_bit(attacks, target);
-                    
-                    // If this square is occupied, stop
-                    if (test_bit(occupied, target)) {
-                        break;
-                    }
-                    
-                    new_file += rook_dx[i];
-                    new_rank += rook_dy[i];
-                }
-            }
-            return attacks;
+            new_file += slider_dx[i];
+            new_rank += slider_dy[i];
         }
-        case QUEEN: {
-            Bitboard attacks = 0;
-            int file = file_of(sq);
-            int rank = rank_of(sq);
-            
-            // Check all eight directions (orthogonal + diagonal)
-            const int queen_dx[] = {-1, -1, -1, 0, 0, 1, 1, 1};
-            const int queen_dy[] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    }
+    return attacks;
+}
+
+bool verify_magics() {
+    SliderBackend selected = slider_backend;
+    bool ok = true;
+    
+    const SliderBackend backends[] = { SLIDER_MAGIC, SLIDER_PEXT };
+    for (SliderBackend backend : backends) {
+        if (!set_slider_backend(backend)) continue;
+        
+        for (int sq = 0; sq < 64; sq++) {
+            // Every subset of each mask, plus the bits outside it that must be ignored
+            Bitboard occupied = 0;
+            do {
+                Bitboard noise = ~BISHOP_MAGICS[sq].mask & 0x8100000000000081ULL;
+                ok &= bishop_attacks(Square(sq), occupied | noise) == sliding_attacks(BISHOP, Square(sq), occupied | noise);
+                occupied = (occupied - BISHOP_MAGICS[sq].mask) & BISHOP_MAGICS[sq].mask;
+            } while (occupied);
             
-            for (int i = 0; i < 8; i++) {
-                int new_file = file + queen_dx[i];
-                int new_rank = rank + queen_dy[i];
-                
-                while (new_file >= 0 && new_file < 8 && new_rank >= 0 && new_rank < 8) {
-                    Square target = make_square(File(new_file), Rank(new_rank));
-                    set_bit(attacks, target);
-                    
-                    // If this square is occupied, stop
-                    if (test_bit(occupied, target)) {
-                        break;
-                    }
-                    
-                    new_file += queen_dx[i];
-                    new_rank += queen_dy[i];
-                }
-            }
-            return attacks;
+            do {
+                Bitboard noise = ~ROOK_MAGICS[sq].mask & 0x8100000000000081ULL;
+                ok &= rook_attacks(Square(sq), occupied | noise) == sliding_attacks(ROOK, Square(sq), occupied | noise);
+                occupied = (occupied - ROOK_MAGICS[sq].mask) & ROOK_MAGICS[sq].mask;
+            } while (occupied);
         }
-        case KING:
-            return KING_ATTACKS[sq];
-        default:
-            return 0;
     }
+    
+    slider_backend = selected;
+    return ok;
 }
 
 } // namespace BitboardUtils 
\ No newline at end of file
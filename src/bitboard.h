@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <cstdint>
 #include <string>
 
@@ -49,82 +50,337 @@ enum Rank : int {
 constexpr Bitboard EMPTY_BB = 0ULL;
 constexpr Bitboard FULL_BB = 0xFFFFFFFFFFFFFFFFULL;
 
+// All lookup tables below are generated at compile time, so there is nothing
+// to initialize at startup and lookups with constant arguments fold away.
+
 // File and rank bitboards
-extern Bitboard FILE_BB[8];
-extern Bitboard RANK_BB[8];
+inline constexpr std::array<Bitboard, 8> FILE_BB = [] {
+    std::array<Bitboard, 8> table{};
+    for (int f = 0; f < 8; f++) {
+        table[f] = 0x0101010101010101ULL << f;
+    }
+    return table;
+}();
+
+inline constexpr std::array<Bitboard, 8> RANK_BB = [] {
+    std::array<Bitboard, 8> table{};
+    for (int r = 0; r < 8; r++) {
+        table[r] = 0xFFULL << (r * 8);
+    }
+    return table;
+}();
 
 // Square bitboards
-extern Bitboard SQUARE_BB[64];
+inline constexpr std::array<Bitboard, 64> SQUARE_BB = [] {
+    std::array<Bitboard, 64> table{};
+    for (int sq = 0; sq < 64; sq++) {
+        table[sq] = 1ULL << sq;
+    }
+    return table;
+}();
+
+// Bitboard of the squares reached by stepping (df, dr) from sq up to 'steps'
+// times, stopping at the board edge
+constexpr Bitboard step_bb(int sq, int df, int dr, int steps) {
+    Bitboard bb = 0;
+    int file = (sq & 7) + df;
+    int rank = (sq >> 3) + dr;
+    for (int i = 0; i < steps && file >= 0 && file < 8 && rank >= 0 && rank < 8; i++) {
+        bb |= 1ULL << (rank * 8 + file);
+        file += df;
+        rank += dr;
+    }
+    return bb;
+}
 
 // Direction bitboards for sliding pieces
-extern Bitboard RAYS[8][64];
+// [N, S, E, W, NE, NW, SE, SW][square], excluding the square itself
+inline constexpr std::array<std::array<Bitboard, 64>, 8> RAYS = [] {
+    const int dx[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+    const int dy[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+    std::array<std::array<Bitboard, 64>, 8> table{};
+    for (int dir = 0; dir < 8; dir++) {
+        for (int sq = 0; sq < 64; sq++) {
+            table[dir][sq] = step_bb(sq, dx[dir], dy[dir], 7);
+        }
+    }
+    return table;
+}();
 
 // Pawn attack tables
-extern Bitboard PAWN_ATTACKS[2][64];
+inline constexpr std::array<std::array<Bitboard, 64>, 2> PAWN_ATTACKS = [] {
+    std::array<std::array<Bitboard, 64>, 2> table{};
+    for (int sq = 0; sq < 64; sq++) {
+        table[0][sq] = step_bb(sq, -1, 1, 1) | step_bb(sq, 1, 1, 1);   // WHITE
+        table[1][sq] = step_bb(sq, -1, -1, 1) | step_bb(sq, 1, -1, 1); // BLACK
+    }
+    return table;
+}();
 
 // Knight and king attack tables
-extern Bitboard KNIGHT_ATTACKS[64];
-extern Bitboard KING_ATTACKS[64];
+inline constexpr std::array<Bitboard, 64> KNIGHT_ATTACKS = [] {
+    const int knight_dx[] = {-2, -2, -1, -1, 1, 1, 2, 2};
+    const int knight_dy[] = {-1, 1, -2, 2, -2, 2, -1, 1};
+    std::array<Bitboard, 64> table{};
+    for (int sq = 0; sq < 64; sq++) {
+        for (int i = 0; i < 8; i++) {
+            table[sq] |= step_bb(sq, knight_dx[i], knight_dy[i], 1);
+        }
+    }
+    return table;
+}();
+
+inline constexpr std::array<Bitboard, 64> KING_ATTACKS = [] {
+    std::array<Bitboard, 64> table{};
+    for (int sq = 0; sq < 64; sq++) {
+        for (int df = -1; df <= 1; df++) {
+            for (int dr = -1; dr <= 1; dr++) {
+                if (df != 0 || dr != 0) table[sq] |= step_bb(sq, df, dr, 1);
+            }
+        }
+    }
+    return table;
+}();
 
-// Bishop and rook magic tables (deprecated - using step-by-step approach)
-// extern Bitboard BISHOP_ATTACKS[64][512];
-// extern Bitboard ROOK_ATTACKS[64][4096];
+static_assert(KNIGHT_ATTACKS[0] == 0x0000000000020400ULL, "knight attacks from a1 are b3 and c2");
+static_assert(KING_ATTACKS[63] == 0x40C0000000000000ULL, "king attacks from h8 are g8, g7 and h7");
+
+// Line tables for aligned square pairs (same rank, file or diagonal); both
+// are empty when the squares are not aligned.
+// BETWEEN_BB: the squares strictly between the two
+inline constexpr std::array<std::array<Bitboard, 64>, 64> BETWEEN_BB = [] {
+    const int dx[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+    const int dy[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+    std::array<std::array<Bitboard, 64>, 64> table{};
+    for (int from = 0; from < 64; from++) {
+        for (int dir = 0; dir < 8; dir++) {
+            Bitboard between = 0;
+            int file = (from & 7) + dx[dir];
+            int rank = (from >> 3) + dy[dir];
+            for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += dx[dir], rank += dy[dir]) {
+                table[from][rank * 8 + file] = between;
+                between |= 1ULL << (rank * 8 + file);
+            }
+        }
+    }
+    return table;
+}();
+
+// LINE_BB: the whole edge-to-edge line through both
+inline constexpr std::array<std::array<Bitboard, 64>, 64> LINE_BB = [] {
+    const int dx[4] = {0, 1, 1, 1};
+    const int dy[4] = {1, 0, 1, -1};
+    std::array<std::array<Bitboard, 64>, 64> table{};
+    for (int from = 0; from < 64; from++) {
+        for (int dir = 0; dir < 4; dir++) {
+            Bitboard line = step_bb(from, dx[dir], dy[dir], 7) | step_bb(from, -dx[dir], -dy[dir], 7) | (1ULL << from);
+            Bitboard others = line & ~(1ULL << from);
+            while (others) {
+                table[from][__builtin_ctzll(others)] = line;
+                others &= others - 1;
+            }
+        }
+    }
+    return table;
+}();
+
+static_assert(BETWEEN_BB[A1][D4] == 0x0000000000040200ULL, "b2 and c3 lie between a1 and d4");
+static_assert(BETWEEN_BB[A1][B3] == 0, "a1 and b3 are not aligned");
+static_assert(LINE_BB[B1][B5] == 0x0202020202020202ULL, "b1 and b5 share the b-file");
+
+// Sliding attack table indexing schemes. PEXT needs BMI2 and is only picked
+// at startup when the host CPU has a fast implementation of it.
+enum SliderBackend : int {
+    SLIDER_MAGIC = 0,
+    SLIDER_PEXT = 1
+};
 
-// Magic numbers for sliding piece move generation (deprecated)
-// extern Bitboard BISHOP_MAGIC[64];
-// extern Bitboard ROOK_MAGIC[64];
+// Detected once during static initialization; cheap (a CPUID call)
+extern SliderBackend slider_backend;
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CHESS_HAS_PEXT 1
+// Emitted as inline asm so the binary itself does not require BMI2; it is
+// only executed once CPUID has confirmed support
+inline Bitboard pext(Bitboard bb, Bitboard mask) {
+    Bitboard result;
+    asm("pextq %2, %1, %0" : "=r"(result) : "r"(bb), "rm"(mask));
+    return result;
+}
+#else
+#define CHESS_HAS_PEXT 0
+#endif
+
+// Fancy magic entry for one square: the relevant occupancy mask, the magic
+// multiplier and the square's first slot in the shared attack tables
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    unsigned offset;
+    unsigned shift;
+    
+    unsigned index(Bitboard occupied) const {
+#if CHESS_HAS_PEXT
+        if (slider_backend == SLIDER_PEXT) {
+            return offset + unsigned(pext(occupied, mask));
+        }
+#endif
+        return offset + unsigned(((occupied & mask) * magic) >> shift);
+    }
+};
+
+// Bishop and rook magic tables. The attack tables hold one row per backend
+// since magic and PEXT order each square's slots differently. They are
+// generated at compile time in bitboard.cpp so only that file pays for them.
+extern const std::array<Magic, 64> BISHOP_MAGICS;
+extern const std::array<Magic, 64> ROOK_MAGICS;
+extern const std::array<std::array<Bitboard, 0x1480>, 2> BISHOP_ATTACKS;
+extern const std::array<std::array<Bitboard, 0x19000>, 2> ROOK_ATTACKS;
 
 // Utility functions
 namespace BitboardUtils {
-    // Initialize all lookup tables
-    void init();
+    // Bit manipulation (compile to popcnt/tzcnt/lzcnt where available)
+    constexpr int popcount(Bitboard bb) {
+        return __builtin_popcountll(bb);
+    }
+    
+    // Least/most significant set bit; bb must be non-zero
+    constexpr Square lsb(Bitboard bb) {
+        return Square(__builtin_ctzll(bb));
+    }
     
-    // Bit manipulation
-    int popcount(Bitboard bb);
-    int lsb(Bitboard bb);
-    int msb(Bitboard bb);
-    Bitboard pop_lsb(Bitboard& bb);
+    constexpr Square msb(Bitboard bb) {
+        return Square(63 ^ __builtin_clzll(bb));
+    }
+    
+    // Clear the least significant set bit and return its square
+    constexpr Square pop_lsb(Bitboard& bb) {
+        Square sq = lsb(bb);
+        bb &= bb - 1;
+        return sq;
+    }
     
     // Square utilities
-    Square make_square(File file, Rank rank);
-    File file_of(Square sq);
-    Rank rank_of(Square sq);
-    Square relative_square(Color c, Square sq);
+    constexpr Square make_square(File file, Rank rank) {
+        return Square(rank * 8 + file);
+    }
+    
+    constexpr File file_of(Square sq) {
+        return File(sq & 7);
+    }
+    
+    constexpr Rank rank_of(Square sq) {
+        return Rank(sq >> 3);
+    }
+    
+    constexpr Square relative_square(Color c, Square sq) {
+        return c == WHITE ? sq : Square(sq ^ 56);
+    }
     
     // String conversion
     std::string square_to_string(Square sq);
     Square string_to_square(const std::string& str);
     
-    // Direction utilities
-    bool is_attacked(Square sq, Color by_color, const Bitboard pieces[2][6]);
+    // Every piece of either color attacking sq, given the occupancy to use for sliders
+    Bitboard attackers_to(Square sq, Bitboard occupied, const Bitboard pieces[2][6]);
     Bitboard get_attacks(Piece piece, Square sq, Color color, Bitboard occupied);
+    
+    // Reference step-by-step slider attacks, used to build and verify the magic tables
+    Bitboard sliding_attacks(Piece piece, Square sq, Bitboard occupied);
+    
+    // Compare the magic lookups against sliding_attacks for every square and occupancy subset
+    bool verify_magics();
+    
+    // Slider backend selection. The fastest supported backend is picked at
+    // startup; set_slider_backend returns false if the CPU lacks it.
+    bool cpu_has_fast_pext();
+    bool set_slider_backend(SliderBackend backend);
+    const char* slider_backend_name(SliderBackend backend);
 }
 
 // Inline functions for performance
-inline Bitboard square_bb(Square sq) {
+constexpr Bitboard square_bb(Square sq) {
     return SQUARE_BB[sq];
 }
 
-inline Bitboard file_bb(File file) {
+constexpr Bitboard file_bb(File file) {
     return FILE_BB[file];
 }
 
-inline Bitboard rank_bb(Rank rank) {
+constexpr Bitboard rank_bb(Rank rank) {
     return RANK_BB[rank];
 }
 
-inline bool test_bit(Bitboard bb, Square sq) {
+constexpr bool test_bit(Bitboard bb, Square sq) {
     return (bb & square_bb(sq)) != 0;
 }
 
-inline void set_bit(Bitboard& bb, Square sq) {
+constexpr void set_bit(Bitboard& bb, Square sq) {
     bb |= square_bb(sq);
 }
 
-inline void clear_bit(Bitboard& bb, Square sq) {
+constexpr void clear_bit(Bitboard& bb, Square sq) {
     bb &= ~square_bb(sq);
 }
 
-inline void flip_bit(Bitboard& bb, Square sq) {
+constexpr void flip_bit(Bitboard& bb, Square sq) {
     bb ^= square_bb(sq);
-} 
\ No newline at end of file
+}
+
+// Shift every square by a square delta (north is +8, east is +1), dropping
+// squares that would wrap around from one edge file to the other
+template <int Delta>
+constexpr Bitboard shift_bb(Bitboard bb) {
+    if constexpr (Delta == 8 || Delta == 16) return bb << Delta;
+    else if constexpr (Delta == -8 || Delta == -16) return bb >> -Delta;
+    else if constexpr (Delta == 9) return (bb & ~FILE_BB[FILE_H]) << 9;
+    else if constexpr (Delta == 7) return (bb & ~FILE_BB[FILE_A]) << 7;
+    else if constexpr (Delta == -7) return (bb & ~FILE_BB[FILE_H]) >> 7;
+    else if constexpr (Delta == -9) return (bb & ~FILE_BB[FILE_A]) >> 9;
+    else static_assert(Delta == 8, "unsupported shift");
+}
+
+static_assert(shift_bb<9>(0x8000000000000080ULL) == 0, "no wrap from the h-file");
+static_assert(shift_bb<-9>(0x0000000000000200ULL) == 0x1ULL, "b2 shifted south-west is a1");
+
+inline Bitboard bishop_attacks(Square sq, Bitboard occupied) {
+    return BISHOP_ATTACKS[slider_backend][BISHOP_MAGICS[sq].index(occupied)];
+}
+
+inline Bitboard rook_attacks(Square sq, Bitboard occupied) {
+    return ROOK_ATTACKS[slider_backend][ROOK_MAGICS[sq].index(occupied)];
+}
+
+inline Bitboard BitboardUtils::get_attacks(Piece piece, Square sq, Color color, Bitboard occupied) {
+    switch (piece) {
+        case PAWN:
+            return PAWN_ATTACKS[color][sq];
+        case KNIGHT:
+            return KNIGHT_ATTACKS[sq];
+        case BISHOP:
+            return bishop_attacks(sq, occupied);
+        case ROOK:
+            return rook_attacks(sq, occupied);
+        case QUEEN:
+            return bishop_attacks(sq, occupied) | rook_attacks(sq, occupied);
+        case KING:
+            return KING_ATTACKS[sq];
+        default:
+            return 0;
+    }
+}
+
+// Super-piece lookup: put every piece type on sq and intersect its attacks
+// with the pieces of that type, since attacks are symmetric (except pawns,
+// which use the opposite color's pattern)
+inline Bitboard BitboardUtils::attackers_to(Square sq, Bitboard occupied, const Bitboard pieces[2][6]) {
+    Bitboard diagonal = pieces[WHITE][BISHOP] | pieces[BLACK][BISHOP] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN];
+    Bitboard orthogonal = pieces[WHITE][ROOK] | pieces[BLACK][ROOK] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN];
+    
+    return (PAWN_ATTACKS[BLACK][sq] & pieces[WHITE][PAWN])
+         | (PAWN_ATTACKS[WHITE][sq] & pieces[BLACK][PAWN])
+         | (KNIGHT_ATTACKS[sq] & (pieces[WHITE][KNIGHT] | pieces[BLACK][KNIGHT]))
+         | (KING_ATTACKS[sq] & (pieces[WHITE][KING] | pieces[BLACK][KING]))
+         | (bishop_attacks(sq, occupied) & diagonal)
+         | (rook_attacks(sq, occupied) & orthogonal);
+}
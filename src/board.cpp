@@ -1,22 +1,26 @@
 #include "board.h"
 #include "movegen.h"
+#include "zobrist.h"
+#include <cassert>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <algorithm>
+#include <type_traits>
 
 // Move constructor
 Move::Move(Square from, Square to, Type type, Piece promotion) {
     data = from | (to << 6) | (type << 12);
     if (promotion != PIECE_NONE) {
-        data |= (promotion << 12);
+        data |= (promotion - KNIGHT) << 12;
     }
 }
 
 std::string Move::to_string() const {
     std::string result = BitboardUtils::square_to_string(from()) + BitboardUtils::square_to_string(to());
     if (is_promotion()) {
-        const char promo_chars[] = {'q', 'r', 'b', 'n'};
-        result += promo_chars[promotion() - 1];
+        const char promo_chars[] = {'n', 'b', 'r', 'q'};
+        result += promo_chars[promotion() - KNIGHT];
     }
     return result;
 }
@@ -82,52 +86,75 @@ void Board::clear_board() {
             pieces[c][p] = 0;
         }
     }
+    for (int sq = 0; sq < 64; sq++) {
+        mailbox[sq] = EMPTY_SQUARE;
+    }
+    by_color[WHITE] = by_color[BLACK] = 0;
+    occupied = 0;
     state = GameState();
-    move_history.clear();
+    key = 0;
 }
 
 void Board::set_piece(Square sq, Piece piece, Color color) {
     if (piece != PIECE_NONE && color != COLOR_NONE) {
-        set_bit(pieces[color][piece], sq);
+        put_piece(sq, piece, color);
     }
 }
 
-Piece Board::get_piece(Square sq) const {
-    for (int p = 0; p < 6; p++) {
-        if (test_bit(pieces[WHITE][p], sq)) return Piece(p);
-        if (test_bit(pieces[BLACK][p], sq)) return Piece(p);
-    }
-    return PIECE_NONE;
+void Board::put_piece(Square sq, Piece piece, Color color) {
+    set_bit(pieces[color][piece], sq);
+    set_bit(by_color[color], sq);
+    set_bit(occupied, sq);
+    mailbox[sq] = uint8_t((color << 3) | piece);
+    key ^= Zobrist::piece_key(color, piece, sq);
 }
 
-Color Board::get_color(Square sq) const {
-    for (int p = 0; p < 6; p++) {
-        if (test_bit(pieces[WHITE][p], sq)) return WHITE;
-        if (test_bit(pieces[BLACK][p], sq)) return BLACK;
-    }
-    return COLOR_NONE;
+void Board::remove_piece(Square sq) {
+    Piece piece = get_piece(sq);
+    Color color = get_color(sq);
+    clear_bit(pieces[color][piece], sq);
+    clear_bit(by_color[color], sq);
+    clear_bit(occupied, sq);
+    mailbox[sq] = EMPTY_SQUARE;
+    key ^= Zobrist::piece_key(color, piece, sq);
 }
 
-Bitboard Board::get_occupied() const {
-    Bitboard occupied = 0;
-    for (int c = 0; c < 2; c++) {
-        for (int p = 0; p < 6; p++) {
-            occupied |= pieces[c][p];
-        }
-    }
-    return occupied;
+void Board::move_piece(Square from, Square to) {
+    Piece piece = get_piece(from);
+    Color color = get_color(from);
+    Bitboard from_to = square_bb(from) | square_bb(to);
+    pieces[color][piece] ^= from_to;
+    by_color[color] ^= from_to;
+    occupied ^= from_to;
+    mailbox[to] = mailbox[from];
+    mailbox[from] = EMPTY_SQUARE;
+    key ^= Zobrist::piece_key(color, piece, from) ^ Zobrist::piece_key(color, piece, to);
 }
 
-Bitboard Board::get_occupied_by_color(Color color) const {
-    Bitboard occupied = 0;
+bool Board::is_consistent() const {
+    Bitboard all[2] = {0, 0};
     for (int p = 0; p < 6; p++) {
-        occupied |= pieces[color][p];
+        all[WHITE] |= pieces[WHITE][p];
+        all[BLACK] |= pieces[BLACK][p];
     }
-    return occupied;
-}
-
-bool Board::is_square_occupied(Square sq) const {
-    return get_piece(sq) != PIECE_NONE;
+    if (all[WHITE] != by_color[WHITE] || all[BLACK] != by_color[BLACK] || (all[WHITE] | all[BLACK]) != occupied) {
+        return false;
+    }
+    
+    for (int sq = 0; sq < 64; sq++) {
+        Piece piece = PIECE_NONE;
+        Color color = COLOR_NONE;
+        for (int c = 0; c < 2; c++) {
+            for (int p = 0; p < 6; p++) {
+                if (!test_bit(pieces[c][p], Square(sq))) continue;
+                if (piece != PIECE_NONE) return false; // Two pieces on one square
+                piece = Piece(p);
+                color = Color(c);
+            }
+        }
+        if (get_piece(Square(sq)) != piece || get_color(Square(sq)) != color) return false;
+    }
+    return key == compute_key();
 }
 
 void Board::reset_to_starting_position() {
@@ -162,6 +189,11 @@ void Board::set_fen(const std::string& fen) {
                 case 'k': piece = KING; break;
                 default: continue;
             }
+            // Too many files in a rank or too many ranks would index past
+            // the mailbox and the Zobrist tables
+            if (file >= 8 || rank < 0) {
+                throw std::invalid_argument("FEN piece placement runs off the board");
+            }
             set_piece(BitboardUtils::make_square(File(file), Rank(rank)), piece, color);
             file++;
         }
@@ -182,6 +214,24 @@ void Board::set_fen(const std::string& fen) {
     // Parse move counters
     state.halfmove_clock = halfmove_part.empty() ? 0 : std::stoi(halfmove_part);
     state.fullmove_number = fullmove_part.empty() ? 1 : std::stoi(fullmove_part);
+    
+    key = compute_key();
+}
+
+uint64_t Board::compute_key() const {
+    uint64_t hash = 0;
+    for (int c = 0; c < 2; c++) {
+        for (int p = 0; p < 6; p++) {
+            Bitboard bb = pieces[c][p];
+            while (bb) {
+                hash ^= Zobrist::piece_key(Color(c), Piece(p), BitboardUtils::pop_lsb(bb));
+            }
+        }
+    }
+    if (state.side_to_move == BLACK) hash ^= Zobrist::KEYS.side;
+    hash ^= Zobrist::castling_key(state.castling_rights);
+    hash ^= Zobrist::en_passant_key(state.en_passant_square);
+    return hash;
 }
 
 std::string Board::get_fen() const {
@@ -241,12 +291,21 @@ std::string Board::get_fen() const {
     return oss.str();
 }
 
+// Board copies happen once per candidate move in legality checks and search,
+// so they must stay a plain memcpy
+static_assert(std::is_trivially_copyable<Board>::value, "Board must be trivially copyable");
+
 void Board::make_move(const Move& move) {
-    // Save current state
     MoveInfo info;
+    make_move(move, info);
+}
+
+void Board::make_move(const Move& move, MoveInfo& info) {
+    // Save current state
     info.move = move;
     info.en_passant_square = state.en_passant_square;
     info.halfmove_clock = state.halfmove_clock;
+    info.key = key;
     for (int c = 0; c < 2; c++) {
         for (int s = 0; s < 2; s++) {
             info.castling_rights[c][s] = state.castling_rights[c][s];
@@ -258,19 +317,24 @@ void Board::make_move(const Move& move) {
     Piece piece = get_piece(from);
     Color color = get_color(from);
     
+    // Castling rights and en passant are re-added to the key once updated
+    key ^= Zobrist::castling_key(state.castling_rights);
+    key ^= Zobrist::en_passant_key(state.en_passant_square);
+    
     // Handle capture
-    if (is_square_occupied(to)) {
-        info.captured_piece = get_piece(to);
+    info.captured_piece = get_piece(to);
+    if (info.captured_piece != PIECE_NONE) {
         info.captured_square = to;
-        clear_bit(pieces[get_color(to)][info.captured_piece], to);
+        remove_piece(to);
     } else {
-        info.captured_piece = PIECE_NONE;
         info.captured_square = SQUARE_NONE;
     }
     
     // Move piece
-    clear_bit(pieces[color][piece], from);
-    set_bit(pieces[color][piece], to);
+    move_piece(from, to);
+    
+    // An en passant square only survives the move right after a double push
+    state.en_passant_square = SQUARE_NONE;
     
     // Handle special moves
     switch (move.type()) {
@@ -281,8 +345,9 @@ void Board::make_move(const Move& move) {
         }
             
         case Move::EN_PASSANT: {
-            Square ep_square = state.en_passant_square;
-            clear_bit(pieces[!color][PAWN], ep_square);
+            // The captured pawn sits beside the moving pawn, behind the target square
+            Square ep_square = BitboardUtils::make_square(BitboardUtils::file_of(to), BitboardUtils::rank_of(from));
+            remove_piece(ep_square);
             info.captured_piece = PAWN;
             info.captured_square = ep_square;
             break;
@@ -292,8 +357,7 @@ void Board::make_move(const Move& move) {
             // Move rook
             Square rook_from = (color == WHITE) ? H1 : H8;
             Square rook_to = (color == WHITE) ? F1 : F8;
-            clear_bit(pieces[color][ROOK], rook_from);
-            set_bit(pieces[color][ROOK], rook_to);
+            move_piece(rook_from, rook_to);
             break;
         }
             
@@ -301,30 +365,31 @@ void Board::make_move(const Move& move) {
             // Move rook
             Square rook_from_q = (color == WHITE) ? A1 : A8;
             Square rook_to_q = (color == WHITE) ? D1 : D8;
-            clear_bit(pieces[color][ROOK], rook_from_q);
-            set_bit(pieces[color][ROOK], rook_to_q);
+            move_piece(rook_from_q, rook_to_q);
             break;
         }
             
         case Move::PROMOTION:
         case Move::PROMOTION_CAPTURE: {
-            clear_bit(pieces[color][PAWN], to);
-            set_bit(pieces[color][move.promotion()], to);
+            remove_piece(to);
+            put_piece(to, move.promotion(), color);
             break;
         }
+            
+        default:
+            break;
     }
     
-    // Update castling rights
+    // Update castling rights. Anything leaving or landing on a rook's home
+    // square (including capturing that rook) ends castling on that side.
     if (piece == KING) {
         state.castling_rights[color][0] = state.castling_rights[color][1] = false;
-    } else if (piece == ROOK) {
-        if (from == (color == WHITE ? A1 : A8)) state.castling_rights[color][0] = false;
-        if (from == (color == WHITE ? H1 : H8)) state.castling_rights[color][1] = false;
     }
-    
-    // Update en passant square
-    if (piece != PAWN && !move.is_capture()) {
-        state.en_passant_square = SQUARE_NONE;
+    for (Square sq : {from, to}) {
+        if (sq == A1) state.castling_rights[WHITE][0] = false;
+        if (sq == H1) state.castling_rights[WHITE][1] = false;
+        if (sq == A8) state.castling_rights[BLACK][0] = false;
+        if (sq == H8) state.castling_rights[BLACK][1] = false;
     }
     
     // Update move counters
@@ -340,17 +405,16 @@ void Board::make_move(const Move& move) {
     
     // Switch sides
     state.side_to_move = (state.side_to_move == WHITE) ? BLACK : WHITE;
+    key ^= Zobrist::KEYS.side;
+    key ^= Zobrist::castling_key(state.castling_rights);
+    key ^= Zobrist::en_passant_key(state.en_passant_square);
     
-    // Save move info
-    move_history.push_back(info);
+    // Debug builds recheck the mailbox and recompute the hash from scratch
+    // to catch incremental bugs
+    assert(is_consistent());
 }
 
-void Board::undo_move() {
-    if (move_history.empty()) return;
-    
-    MoveInfo info = move_history.back();
-    move_history.pop_back();
-    
+void Board::undo_move(const MoveInfo& info) {
     // Restore state
     state.side_to_move = (state.side_to_move == WHITE) ? BLACK : WHITE;
     state.en_passant_square = info.en_passant_square;
@@ -360,16 +424,22 @@ void Board::undo_move() {
             state.castling_rights[c][s] = info.castling_rights[c][s];
         }
     }
+    if (state.side_to_move == BLACK) {
+        state.fullmove_number--;
+    }
     
     Move move = info.move;
     Square from = move.from();
     Square to = move.to();
-    Piece piece = get_piece(to);
     Color color = get_color(to);
     
-    // Restore piece to original square
-    clear_bit(pieces[color][piece], to);
-    set_bit(pieces[color][piece], from);
+    // Restore piece to original square (a promoted piece turns back into a pawn)
+    if (move.is_promotion()) {
+        remove_piece(to);
+        put_piece(from, PAWN, color);
+    } else {
+        move_piece(to, from);
+    }
     
     // Handle special moves
     switch (move.type()) {
@@ -377,8 +447,7 @@ void Board::undo_move() {
             // Restore rook
             Square rook_from = (color == WHITE) ? H1 : H8;
             Square rook_to = (color == WHITE) ? F1 : F8;
-            clear_bit(pieces[color][ROOK], rook_to);
-            set_bit(pieces[color][ROOK], rook_from);
+            move_piece(rook_to, rook_from);
             break;
         }
             
@@ -386,54 +455,73 @@ void Board::undo_move() {
             // Restore rook
             Square rook_from_q = (color == WHITE) ? A1 : A8;
             Square rook_to_q = (color == WHITE) ? D1 : D8;
-            clear_bit(pieces[color][ROOK], rook_to_q);
-            set_bit(pieces[color][ROOK], rook_from_q);
+            move_piece(rook_to_q, rook_from_q);
             break;
         }
             
-        case Move::PROMOTION:
-        case Move::PROMOTION_CAPTURE: {
-            clear_bit(pieces[color][move.promotion()], from);
-            set_bit(pieces[color][PAWN], from);
+        default:
             break;
-        }
     }
     
     // Restore captured piece
     if (info.captured_piece != PIECE_NONE) {
         Color captured_color = (color == WHITE) ? BLACK : WHITE;
-        set_bit(pieces[captured_color][info.captured_piece], info.captured_square);
+        put_piece(info.captured_square, info.captured_piece, captured_color);
     }
-}
-
-std::vector<Move> Board::generate_legal_moves() const {
-    std::vector<Move> pseudo_legal = generate_pseudo_legal_moves();
-    std::vector<Move> legal;
     
-    for (const Move& move : pseudo_legal) {
-        // Make move temporarily
-        Board temp_board = *this;
-        temp_board.make_move(move);
+    key = info.key;
+    assert(is_consistent());
+}
 
-        //If the king is currently in check, check if king isn't after the move
-        // rnb1kbnr/pp1pp1pp/2p2p2/q7/3PP3/5N2/PPPQ1PPP/RNB1KB1R b KQkq - 3 4
-        if (this->is_in_check(state.side_to_move) && !temp_board.is_in_check(state.side_to_move)){
-            legal.push_back(move);
-        }else if(!temp_board.is_in_check(state.side_to_move)) {
-            // Check if king is in check after move
-            legal.push_back(move);
+void Board::make_null_move(MoveInfo& info) {
+    info.move = Move();
+    info.captured_piece = PIECE_NONE;
+    info.captured_square = SQUARE_NONE;
+    info.en_passant_square = state.en_passant_square;
+    info.halfmove_clock = state.halfmove_clock;
+    info.key = key;
+    for (int c = 0; c < 2; c++) {
+        for (int s = 0; s < 2; s++) {
+            info.castling_rights[c][s] = state.castling_rights[c][s];
         }
     }
     
-    return legal;
+    key ^= Zobrist::en_passant_key(state.en_passant_square);
+    state.en_passant_square = SQUARE_NONE;
+    state.side_to_move = (state.side_to_move == WHITE) ? BLACK : WHITE;
+    key ^= Zobrist::KEYS.side;
+    
+    assert(is_consistent());
+}
+
+void Board::undo_null_move(const MoveInfo& info) {
+    state.side_to_move = (state.side_to_move == WHITE) ? BLACK : WHITE;
+    state.en_passant_square = info.en_passant_square;
+    key = info.key;
+}
+
+void Board::generate_legal_moves(MoveList& moves) const {
+    MoveGen::generate_legal_moves(*this, moves);
+}
+
+void Board::generate_quiet_moves(MoveList& moves) const {
+    MoveGen::generate_quiet_moves(*this, moves);
+}
+
+int Board::count_legal_moves() const {
+    return MoveGen::count_legal_moves(*this);
 }
 
-std::vector<Move> Board::generate_pseudo_legal_moves() const {
-    return MoveGen::generate_moves(*this);
+bool Board::has_any_legal_move() const {
+    return MoveGen::has_any_legal_move(*this);
 }
 
-std::vector<Move> Board::generate_captures() const {
-    return MoveGen::generate_captures(*this);
+void Board::generate_pseudo_legal_moves(MoveList& moves) const {
+    MoveGen::generate_moves(*this, moves);
+}
+
+void Board::generate_tactical_moves(MoveList& moves) const {
+    MoveGen::generate_tactical_moves(*this, moves);
 }
 
 bool Board::is_in_check(Color color) const {
@@ -442,19 +530,21 @@ bool Board::is_in_check(Color color) const {
         // If king is not found, something is wrong with the position
         return false;
     }
-    return BitboardUtils::is_attacked(king_square, (color == WHITE) ? BLACK : WHITE, pieces);
+    return (attackers_to(king_square, get_occupied()) & get_all_pieces((color == WHITE) ? BLACK : WHITE)) != 0;
 }
 
 bool Board::is_checkmate(Color color) const {
-    return is_in_check(color) && generate_legal_moves().empty();
+    return is_in_check(color) && !has_any_legal_move();
 }
 
 bool Board::is_stalemate(Color color) const {
-    return !is_in_check(color) && generate_legal_moves().empty();
+    return !is_in_check(color) && !has_any_legal_move();
 }
 
 bool Board::is_game_over() const {
-    return is_checkmate(state.side_to_move) || is_stalemate(state.side_to_move) || is_draw();
+    // Mate and stalemate both mean no legal moves; the check test only
+    // tells them apart
+    return !has_any_legal_move() || is_draw();
 }
 
 bool Board::is_check() const {
@@ -480,14 +570,6 @@ Color Board::get_winner() const {
     return COLOR_NONE;
 }
 
-Bitboard Board::get_all_pieces(Color color) const {
-    Bitboard all = 0;
-    for (int p = 0; p < 6; p++) {
-        all |= pieces[color][p];
-    }
-    return all;
-}
-
 void Board::print_board() const {
     std::cout << get_board_string() << std::endl;
 }
@@ -531,100 +613,139 @@ int Board::get_piece_count(Color color, Piece piece) const {
 Square Board::get_king_square(Color color) const {
     Bitboard king_bb = pieces[color][KING];
     if (king_bb == 0) return SQUARE_NONE;
-    return Square(BitboardUtils::lsb(king_bb));
+    return BitboardUtils::lsb(king_bb);
 }
 
-bool Board::is_valid_move(const std::string& move_str) const {
-    if (move_str.length() < 4) return false;
+bool Board::is_pseudo_legal(const Move& move) const {
+    if (move.data == 0) return false;
     
-    Square from = BitboardUtils::string_to_square(move_str.substr(0, 2));
-    Square to = BitboardUtils::string_to_square(move_str.substr(2, 2));
-    
-    if (from == SQUARE_NONE || to == SQUARE_NONE) return false;
+    Color us = state.side_to_move;
+    Color them = (us == WHITE) ? BLACK : WHITE;
+    Square from = move.from();
+    Square to = move.to();
+    Piece piece = get_piece(from);
+    Move::Type type = move.type();
     
-    // Check if the piece at 'from' belongs to the side to move
-    Color piece_color = get_color(from);
-    if (piece_color != state.side_to_move) return false;
+    if (get_color(from) != us || test_bit(by_color[us], to)) return false;
     
-    // Determine move type based on the position
-    Move::Type type = Move::NORMAL;
-    Piece promotion = PIECE_NONE;
+    bool enemy_on_to = test_bit(by_color[them], to);
     
-    // Check for captures
-    Color target_color = get_color(to);
-    if (target_color != COLOR_NONE && target_color != state.side_to_move) {
-        type = Move::CAPTURE;
+    if (move.is_castle()) {
+        Square king_from = (us == WHITE) ? E1 : E8;
+        bool kingside = (type == Move::KING_CASTLE);
+        Square king_to = (us == WHITE) ? (kingside ? G1 : C1) : (kingside ? G8 : C8);
+        Square rook_from = (us == WHITE) ? (kingside ? H1 : A1) : (kingside ? H8 : A8);
+        if (piece != KING || from != king_from || to != king_to ||
+            !state.castling_rights[us][kingside] || !test_bit(pieces[us][ROOK], rook_from)) {
+            return false;
+        }
+        
+        // Squares between king and rook empty, king not in check and the
+        // squares it crosses unattacked (legality is settled here, since
+        // is_legal cannot tell a castle from a king move into safety)
+        if (BETWEEN_BB[king_from][rook_from] & occupied) return false;
+        Square crossed = kingside ? Square(king_from + 1) : Square(king_from - 1);
+        for (Square sq : {king_from, crossed, king_to}) {
+            if (attackers_to(sq, occupied) & by_color[them]) return false;
+        }
+        return true;
     }
     
-    // Check for double pawn push
-    Piece piece = get_piece(from);
     if (piece == PAWN) {
-        int from_rank = BitboardUtils::rank_of(from);
-        int to_rank = BitboardUtils::rank_of(to);
-        int from_file = BitboardUtils::file_of(from);
-        int to_file = BitboardUtils::file_of(to);
+        int up = (us == WHITE) ? 8 : -8;
+        Rank last_rank = (us == WHITE) ? RANK_8 : RANK_1;
         
-        if (from_file == to_file && abs(to_rank - from_rank) == 2) {
-            if ((from_rank == 1 && to_rank == 3) || (from_rank == 6 && to_rank == 4)) {
-                type = Move::DOUBLE_PAWN_PUSH;
-            }
-        }
+        // Promotion exactly when the pawn reaches the last rank
+        if (move.is_promotion() != (BitboardUtils::rank_of(to) == last_rank)) return false;
         
-        // Check for promotion
-        if ((state.side_to_move == WHITE && to_rank == 7) ||
-            (state.side_to_move == BLACK && to_rank == 0)) {
-            if (move_str.length() > 4) {
-                char promo = move_str[4];
-                switch (promo) {
-                    case 'q': promotion = QUEEN; break;
-                    case 'r': promotion = ROOK; break;
-                    case 'b': promotion = BISHOP; break;
-                    case 'n': promotion = KNIGHT; break;
-                    default: return false;
-                }
-                type = (type == Move::CAPTURE) ? Move::PROMOTION_CAPTURE : Move::PROMOTION;
-            }
+        switch (type) {
+            case Move::NORMAL:
+            case Move::PROMOTION:
+                return to == from + up && !test_bit(occupied, to);
+            case Move::DOUBLE_PAWN_PUSH:
+                return BitboardUtils::rank_of(from) == ((us == WHITE) ? RANK_2 : RANK_7) &&
+                       to == from + 2 * up &&
+                       !test_bit(occupied, Square(from + up)) && !test_bit(occupied, to);
+            case Move::CAPTURE:
+            case Move::PROMOTION_CAPTURE:
+                return enemy_on_to && test_bit(PAWN_ATTACKS[us][from], to);
+            case Move::EN_PASSANT:
+                return to == state.en_passant_square && test_bit(PAWN_ATTACKS[us][from], to) &&
+                       test_bit(pieces[them][PAWN], Square(to - up));
+            default:
+                return false;
         }
     }
     
-    // Check for en passant
-    if (piece == PAWN && to == state.en_passant_square) {
-        type = Move::EN_PASSANT;
-    }
+    // Pieces other than pawns only make normal moves and plain captures
+    if (type != (enemy_on_to ? Move::CAPTURE : Move::NORMAL)) return false;
+    return test_bit(BitboardUtils::get_attacks(piece, from, us, occupied), to);
+}
+
+bool Board::is_legal(const Move& move) const {
+    Color us = state.side_to_move;
+    Square ksq = get_king_square(us);
+    if (ksq == SQUARE_NONE) return true;
     
-    // Check for castling
-    if (piece == KING) {
-        if ((state.side_to_move == WHITE && from == E1 && to == G1) ||
-            (state.side_to_move == BLACK && from == E8 && to == G8)) {
-            type = Move::KING_CASTLE;
-            std::cout << "DEBUG: Detected KING_CASTLE move\n";
-        } else if ((state.side_to_move == WHITE && from == E1 && to == C1) ||
-                   (state.side_to_move == BLACK && from == E8 && to == C8)) {
-            type = Move::QUEEN_CASTLE;
-            std::cout << "DEBUG: Detected QUEEN_CASTLE move\n";
-        }
+    // Castling was fully checked by is_pseudo_legal
+    if (move.is_castle()) return true;
+    
+    // Play the move on the occupancy alone and look for enemy attackers of
+    // the king's square, ignoring any piece the move captures. Pawn, knight
+    // and king attacks do not depend on occupancy, so this covers checks
+    // left unanswered, pins and the en passant rank pin in one lookup.
+    Square from = move.from();
+    Square to = move.to();
+    Square captured = to;
+    if (move.type() == Move::EN_PASSANT) {
+        captured = BitboardUtils::make_square(BitboardUtils::file_of(to), BitboardUtils::rank_of(from));
     }
     
-    Move move(from, to, type, promotion);
-    std::cout << "DEBUG: Created move with type: " << type << "\n";
+    Bitboard occupied_after = ((occupied ^ square_bb(from)) & ~square_bb(captured)) | square_bb(to);
+    Square king_after = (from == ksq) ? to : ksq;
+    Bitboard enemies = by_color[us == WHITE ? BLACK : WHITE] & ~square_bb(captured);
+    return !(attackers_to(king_after, occupied_after) & enemies);
+}
+
+bool Board::is_valid_move(const std::string& move_str) const {
+    Move move = parse_move(move_str);
+    return is_pseudo_legal(move) && is_legal(move);
+}
+
+Move Board::parse_move(const std::string& move_str) const {
+    if (move_str.length() < 4) return Move();
+    
+    Square from = BitboardUtils::string_to_square(move_str.substr(0, 2));
+    Square to = BitboardUtils::string_to_square(move_str.substr(2, 2));
+    if (from == SQUARE_NONE || to == SQUARE_NONE) return Move();
     
-    std::vector<Move> legal_moves = generate_legal_moves();
-    std::cout << "DEBUG: Generated " << legal_moves.size() << " legal moves\n";
+    // Coordinate notation does not say what kind of move it is, so the type
+    // is read off the board
+    Piece piece = get_piece(from);
+    bool capture = get_color(to) != COLOR_NONE && get_color(to) != get_color(from);
+    Move::Type type = capture ? Move::CAPTURE : Move::NORMAL;
+    Piece promotion = PIECE_NONE;
     
-    // Check if our move is in the legal moves
-    bool found = false;
-    for (const Move& legal_move : legal_moves) {
-        if (legal_move.from() == move.from() && legal_move.to() == move.to() && 
-            legal_move.type() == move.type()) {
-            found = true;
-            break;
+    if (piece == PAWN) {
+        if (to == state.en_passant_square && BitboardUtils::file_of(from) != BitboardUtils::file_of(to)) {
+            type = Move::EN_PASSANT;
+        } else if (std::abs(BitboardUtils::rank_of(to) - BitboardUtils::rank_of(from)) == 2) {
+            type = Move::DOUBLE_PAWN_PUSH;
         }
+        
+        if (move_str.length() > 4) {
+            switch (move_str[4]) {
+                case 'q': promotion = QUEEN; break;
+                case 'r': promotion = ROOK; break;
+                case 'b': promotion = BISHOP; break;
+                case 'n': promotion = KNIGHT; break;
+                default: return Move();
+            }
+            type = capture ? Move::PROMOTION_CAPTURE : Move::PROMOTION;
+        }
+    } else if (piece == KING && std::abs(BitboardUtils::file_of(to) - BitboardUtils::file_of(from)) == 2) {
+        type = (to > from) ? Move::KING_CASTLE : Move::QUEEN_CASTLE;
     }
-    std::cout << "DEBUG: Move found in legal moves: " << (found ? "YES" : "NO") << "\n";
     
-    return std::find(legal_moves.begin(), legal_moves.end(), move) != legal_moves.end();
-}
-
-Move Board::parse_move(const std::string& move_str) const {
-    return Move::from_string(move_str);
+    return Move(from, to, type, promotion);
 } 
\ No newline at end of file
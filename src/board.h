@@ -1,7 +1,6 @@
 #pragma once
 #include "bitboard.h"
 #include <string>
-#include <vector>
 
 // Move structure (16 bits)
 struct Move {
@@ -19,19 +18,21 @@ struct Move {
         PROMOTION_CAPTURE = 12
     };
     
-    // Constructors
-    Move() : data(0) {}
+    // Constructors. Move() value-initializes to the null move (data == 0);
+    // the default constructor is trivial so MoveList storage is not zeroed.
+    Move() = default;
     Move(Square from, Square to, Type type = NORMAL, Piece promotion = PIECE_NONE);
     
-    // Getters
+    // Getters. Bits 0-5 hold the from square, 6-11 the to square and 12-15
+    // the type; for promotions the low two type bits hold the piece (N, B, R, Q).
     Square from() const { return Square(data & 0x3F); }
     Square to() const { return Square((data >> 6) & 0x3F); }
-    Type type() const { return Type((data >> 12) & 0xF); }
-    Piece promotion() const { return Piece((data >> 12) & 0x7); }
+    Type type() const { return is_promotion() ? Type((data >> 12) & PROMOTION_CAPTURE) : Type(data >> 12); }
+    Piece promotion() const { return is_promotion() ? Piece(KNIGHT + ((data >> 12) & 0x3)) : PIECE_NONE; }
     
     // Utility
     bool is_capture() const { return type() == CAPTURE || type() == EN_PASSANT || type() == PROMOTION_CAPTURE; }
-    bool is_promotion() const { return type() >= PROMOTION; }
+    bool is_promotion() const { return (data >> 12) & PROMOTION; }
     bool is_castle() const { return type() == KING_CASTLE || type() == QUEEN_CASTLE; }
     
     // Comparison
@@ -43,6 +44,40 @@ struct Move {
     static Move from_string(const std::string& str);
 };
 
+// Move with a score slot for move ordering
+struct ScoredMove : Move {
+    int score;
+};
+
+// Fixed-capacity move list. Lives on the caller's stack so move generation
+// and search never allocate; 256 exceeds the most moves any position has.
+class MoveList {
+public:
+    static constexpr int MAX_MOVES = 256;
+    
+    MoveList() : count(0) {}
+    
+    void push_back(const Move& move) { moves[count++].data = move.data; }
+    void emplace_back(Square from, Square to, Move::Type type = Move::NORMAL, Piece promotion = PIECE_NONE) {
+        push_back(Move(from, to, type, promotion));
+    }
+    void clear() { count = 0; }
+    
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    ScoredMove& operator[](int i) { return moves[i]; }
+    const ScoredMove& operator[](int i) const { return moves[i]; }
+    ScoredMove* begin() { return moves; }
+    ScoredMove* end() { return moves + count; }
+    const ScoredMove* begin() const { return moves; }
+    const ScoredMove* end() const { return moves + count; }
+    
+private:
+    ScoredMove moves[MAX_MOVES];
+    int count;
+};
+
 // Game state information
 struct GameState {
     Color side_to_move;
@@ -58,33 +93,51 @@ struct GameState {
     }
 };
 
+// Everything make_move overwrites that cannot be recomputed when undoing.
+// Owned by the caller (normally one per ply on the search stack), so Board
+// itself stays a small trivially copyable value with no heap state.
+struct MoveInfo {
+    Move move;
+    Piece captured_piece;
+    Square captured_square;
+    Square en_passant_square;
+    bool castling_rights[2][2];
+    int halfmove_clock;
+    uint64_t key;
+};
+
 // Board class
 class Board {
 private:
     // Piece bitboards [color][piece_type]
     Bitboard pieces[2][6];
     
+    // Mailbox mirror of the bitboards: (color << 3) | piece per square, or
+    // EMPTY_SQUARE, so square queries are a single byte load
+    static constexpr uint8_t EMPTY_SQUARE = (COLOR_NONE << 3) | PIECE_NONE;
+    uint8_t mailbox[64];
+    
+    // Union of each color's piece bitboards, and of both colors
+    Bitboard by_color[2];
+    Bitboard occupied;
+    
     // Game state
     GameState state;
     
-    // Move history for undoing moves
-    struct MoveInfo {
-        Move move;
-        Piece captured_piece;
-        Square captured_square;
-        Square en_passant_square;
-        bool castling_rights[2][2];
-        int halfmove_clock;
-    };
-    std::vector<MoveInfo> move_history;
+    // Zobrist hash of pieces, side to move, castling rights and en passant file
+    uint64_t key;
     
     // Utility functions
     void clear_board();
     void set_piece(Square sq, Piece piece, Color color);
-    Color get_color(Square sq) const;
-    Bitboard get_occupied_by_color(Color color) const;
-    bool is_square_occupied(Square sq) const;
-    bool is_legal_move(const Move& move) const;
+    Color get_color(Square sq) const { return Color(mailbox[sq] >> 3); }
+    bool is_square_occupied(Square sq) const { return mailbox[sq] != EMPTY_SQUARE; }
+    
+    // Piece placement; each keeps the piece and occupancy bitboards, mailbox
+    // and hash key in sync
+    void put_piece(Square sq, Piece piece, Color color);
+    void remove_piece(Square sq);
+    void move_piece(Square from, Square to);
     bool is_checkmate(Color color) const;
     bool is_stalemate(Color color) const;
     
@@ -96,13 +149,24 @@ public:
     // Board manipulation
     void set_fen(const std::string& fen);
     std::string get_fen() const;
-    void make_move(const Move& move);
-    void undo_move();
+    void make_move(const Move& move, MoveInfo& info);
+    void undo_move(const MoveInfo& info);
+    void make_move(const Move& move); // When the move will never be undone
+    
+    // Pass the turn: flip the side to move and clear en passant, leaving the
+    // pieces alone (null-move pruning). info.move is set to the null move.
+    void make_null_move(MoveInfo& info);
+    void undo_null_move(const MoveInfo& info);
     
-    // Move generation
-    std::vector<Move> generate_legal_moves() const;
-    std::vector<Move> generate_pseudo_legal_moves() const;
-    std::vector<Move> generate_captures() const;
+    // Move generation (appends to the caller's list)
+    void generate_legal_moves(MoveList& moves) const;
+    void generate_pseudo_legal_moves(MoveList& moves) const;
+    void generate_tactical_moves(MoveList& moves) const;
+    void generate_quiet_moves(MoveList& moves) const;
+    
+    // Legal move count and existence test, without generating the moves
+    int count_legal_moves() const;
+    bool has_any_legal_move() const;
     
     // Game state queries
     bool is_game_over() const;
@@ -112,13 +176,20 @@ public:
     bool is_draw() const;
     Color get_winner() const;
     bool is_in_check(Color color) const;
+    Bitboard attackers_to(Square sq, Bitboard occupied) const { return BitboardUtils::attackers_to(sq, occupied, pieces); }
     
     // Board queries
-    Piece get_piece(Square sq) const;
+    Piece get_piece(Square sq) const { return Piece(mailbox[sq] & 7); }
     Bitboard get_pieces(Color color, Piece piece) const { return pieces[color][piece]; }
-    Bitboard get_all_pieces(Color color) const;
-    Bitboard get_occupied() const;
+    Bitboard get_all_pieces(Color color) const { return by_color[color]; }
+    Bitboard get_occupied() const { return occupied; }
     GameState get_state() const { return state; }
+    uint64_t get_key() const { return key; }
+    uint64_t compute_key() const;
+    
+    // Check that the mailbox, occupancy and hash key agree with the piece
+    // bitboards (debug aid)
+    bool is_consistent() const;
     Color get_side_to_move() const { return state.side_to_move; }
     const Bitboard (*get_pieces_array() const)[6] { return pieces; }
     
@@ -131,7 +202,12 @@ public:
     int get_piece_count(Color color, Piece piece) const;
     Square get_king_square(Color color) const;
     
-    // Move validation
+    // Move validation. is_pseudo_legal checks that a move from outside the
+    // generator (hash move, killer, user input) could be generated here,
+    // type bits included; is_legal then checks that a pseudo-legal move
+    // does not leave the king in check. Both run in constant time.
+    bool is_pseudo_legal(const Move& move) const;
+    bool is_legal(const Move& move) const;
     bool is_valid_move(const std::string& move_str) const;
     Move parse_move(const std::string& move_str) const;
 }; 
\ No newline at end of file
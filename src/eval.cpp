@@ -1,5 +1,6 @@
 #include "eval.h"
 #include "bitboard.h"
+#include <algorithm>
 
 namespace Eval {
 
@@ -133,14 +134,12 @@ int evaluate_position(const Board& board) {
         Bitboard black_pieces = board.get_pieces(BLACK, Piece(piece));
         
         while (white_pieces) {
-            Bitboard piece_bb = BitboardUtils::pop_lsb(white_pieces);
-            Square sq = Square(BitboardUtils::lsb(piece_bb));
+            Square sq = BitboardUtils::pop_lsb(white_pieces);
             score += get_piece_square_value(Piece(piece), sq, WHITE);
         }
         
         while (black_pieces) {
-            Bitboard piece_bb = BitboardUtils::pop_lsb(black_pieces);
-            Square sq = Square(BitboardUtils::lsb(piece_bb));
+            Square sq = BitboardUtils::pop_lsb(black_pieces);
             score -= get_piece_square_value(Piece(piece), sq, BLACK);
         }
     }
@@ -180,6 +179,72 @@ bool is_endgame(const Board& board) {
     return total_pieces <= 12; // Arbitrary threshold
 }
 
+int see(const Board& board, const Move& move) {
+    if (move.is_castle()) return 0;
+    
+    Square from = move.from();
+    Square to = move.to();
+    const Bitboard (*pieces)[6] = board.get_pieces_array();
+    Bitboard occupied = board.get_occupied() ^ square_bb(from);
+    
+    // gain[d] is the material balance after the d-th capture on the square,
+    // from the point of view of the side making it
+    int gain[32];
+    Piece victim = board.get_piece(to);
+    if (move.type() == Move::EN_PASSANT) {
+        victim = PAWN;
+        occupied ^= square_bb(BitboardUtils::make_square(BitboardUtils::file_of(to), BitboardUtils::rank_of(from)));
+    }
+    gain[0] = get_piece_value(victim);
+    
+    // The piece now standing on the square, which the next capture takes
+    Piece on_square = board.get_piece(from);
+    if (move.is_promotion()) {
+        gain[0] += get_piece_value(move.promotion()) - PIECE_VALUES[PAWN];
+        on_square = move.promotion();
+    }
+    
+    Bitboard diagonal = pieces[WHITE][BISHOP] | pieces[BLACK][BISHOP] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN];
+    Bitboard orthogonal = pieces[WHITE][ROOK] | pieces[BLACK][ROOK] | pieces[WHITE][QUEEN] | pieces[BLACK][QUEEN];
+    Bitboard attackers = board.attackers_to(to, occupied) & occupied;
+    Color side = (board.get_side_to_move() == WHITE) ? BLACK : WHITE;
+    
+    int d = 0;
+    while (d < 31) {
+        Bitboard side_attackers = attackers & board.get_all_pieces(side);
+        if (!side_attackers) break;
+        
+        // Recapture with the least valuable attacker
+        Piece attacker = PAWN;
+        while (!(side_attackers & pieces[side][attacker])) {
+            attacker = Piece(attacker + 1);
+        }
+        
+        d++;
+        gain[d] = get_piece_value(on_square) - gain[d - 1];
+        
+        on_square = attacker;
+        occupied ^= square_bb(BitboardUtils::lsb(side_attackers & pieces[side][attacker]));
+        
+        // Removing the attacker can uncover a slider behind it
+        if (attacker == PAWN || attacker == BISHOP || attacker == QUEEN) {
+            attackers |= bishop_attacks(to, occupied) & diagonal;
+        }
+        if (attacker == ROOK || attacker == QUEEN) {
+            attackers |= rook_attacks(to, occupied) & orthogonal;
+        }
+        attackers &= occupied;
+        side = (side == WHITE) ? BLACK : WHITE;
+    }
+    
+    // Each side may stop capturing instead of continuing a losing exchange
+    while (d > 0) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+        d--;
+    }
+    return gain[0];
+}
+
 int get_piece_value(Piece piece) {
     if (piece >= 0 && piece < 6) {
         return PIECE_VALUES[piece];
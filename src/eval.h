@@ -26,6 +26,14 @@ namespace Eval {
     // Endgame evaluation
     int evaluate_endgame(const Board& board);
     
+    // Static exchange evaluation: the material the side to move wins (or,
+    // if negative, loses) by playing move and continuing the exchange on its
+    // destination square with the least valuable attacker each time, either
+    // side stopping when further captures would lose. Sliders lined up
+    // behind an attacker join in once it has captured (x-rays). Pins and
+    // checks are ignored.
+    int see(const Board& board, const Move& move);
+    
     // Utility functions
     bool is_endgame(const Board& board);
     int get_piece_value(Piece piece);
@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// A 16-byte hash table entry shared by threads without locks, used by the
+// transposition table and the perft hash. It stores key ^ data next to
+// data, so an entry torn by two threads writing at once fails the key check
+// and reads as a miss. data == 0 marks an empty entry.
+struct LocklessEntry {
+    std::atomic<uint64_t> check; // key ^ data
+    std::atomic<uint64_t> data;
+    
+    // The data stored for key, or 0 if the entry is empty, holds another
+    // key or is torn
+    uint64_t probe(uint64_t key) const {
+        uint64_t value = data.load(std::memory_order_relaxed);
+        uint64_t value_check = check.load(std::memory_order_relaxed);
+        return (value_check ^ value) == key ? value : 0;
+    }
+    
+    // The data stored, whatever key it belongs to (replacement decisions
+    // and statistics)
+    uint64_t peek() const { return data.load(std::memory_order_relaxed); }
+    
+    void store(uint64_t key, uint64_t value) {
+        check.store(key ^ value, std::memory_order_relaxed);
+        data.store(value, std::memory_order_relaxed);
+    }
+    
+    void clear() {
+        check.store(0, std::memory_order_relaxed);
+        data.store(0, std::memory_order_relaxed);
+    }
+};
@@ -2,8 +2,12 @@
 #include "search.h"
 #include "eval.h"
 #include "bitboard.h"
+#include "bench.h"
+#include "perft.h"
+#include "tt.h"
 #include <iostream>
 #include <string>
+#include <sstream>
 #include <chrono>
 
 void print_help() {
@@ -13,10 +17,17 @@ void print_help() {
     std::cout << "  go                  - Let engine make a move\n";
     std::cout << "  depth <n>           - Set search depth (default: 4)\n";
     std::cout << "  time <ms>           - Set max search time in milliseconds (default: 5000)\n";
+    std::cout << "  threads <n>         - Set search threads (default: 1)\n";
+    std::cout << "  hash <MB>           - Set transposition table size (default: 16)\n";
+    std::cout << "  clearhash           - Clear the transposition table\n";
     std::cout << "  fen <string>        - Set position from FEN string\n";
     std::cout << "  reset               - Reset to starting position\n";
     std::cout << "  eval                - Show current position evaluation\n";
     std::cout << "  legal               - Show all legal moves\n";
+    std::cout << "  see <move>          - Show the static exchange evaluation of a move\n";
+    std::cout << "  perft <n> [t] [mb]  - Count leaf nodes to depth n (t threads, mb MB perft hash)\n";
+    std::cout << "  divide <n> [t] [mb] - Perft with a count per root move\n";
+    std::cout << "  bench               - Run the engine benchmarks\n";
     std::cout << "  help                - Show this help\n";
     std::cout << "  botvsbot            - Has the bot play against itself\n";
     std::cout << "  quit                - Exit the program\n\n";
@@ -47,10 +58,16 @@ void print_game_status(const Board& board) {
 
 int main() {
     std::cout << "=== C++ Chess Engine ===\n";
-    std::cout << "A highly optimized chess engine using bitboards and magic bitboards\n\n";
+    std::cout << "A highly optimized chess engine using bitboards and magic bitboards\n";
     
-    // Initialize bitboard lookup tables
-    BitboardUtils::init();
+#ifndef NDEBUG
+    // Check the compile-time slider tables against the reference ray walk
+    if (!BitboardUtils::verify_magics()) {
+        std::cout << "Slider attack tables failed their self-check\n";
+        return 1;
+    }
+#endif
+    std::cout << "Slider attacks: " << BitboardUtils::slider_backend_name(slider_backend) << "\n\n";
     
     // Create board and search parameters
     Board board;
@@ -119,6 +136,8 @@ int main() {
                 std::cout << "Engine plays: " << result.best_move.to_string() 
                          << " (depth: " << result.depth 
                          << ", score: " << result.score 
+                         << ", hashfull: " << result.hashfull
+                         << ", ebf: " << result.ebf
                          << ", time: " << duration.count() << "ms)\n";
                 print_game_status(board);
             } else {
@@ -144,6 +163,8 @@ int main() {
                 std::cout << "Engine plays: " << result.best_move.to_string() 
                          << " (depth: " << result.depth 
                          << ", score: " << result.score 
+                         << ", hashfull: " << result.hashfull
+                         << ", ebf: " << result.ebf
                          << ", time: " << duration.count() << "ms)\n";
                 print_game_status(board);
             } else {
@@ -176,6 +197,36 @@ int main() {
                 std::cout << "Invalid time value\n";
             }
             
+        } else if (command.substr(0, 7) == "threads") {
+            try {
+                int threads = std::stoi(command.substr(8));
+                if (threads >= 1 && threads <= 256) {
+                    search_params.threads = threads;
+                    std::cout << "Search threads set to " << threads << "\n";
+                } else {
+                    std::cout << "Threads must be between 1 and 256\n";
+                }
+            } catch (...) {
+                std::cout << "Invalid thread count\n";
+            }
+            
+        } else if (command.substr(0, 4) == "hash") {
+            try {
+                int mb = std::stoi(command.substr(5));
+                if (mb >= 1 && mb <= 65536) {
+                    TT.resize(mb);
+                    std::cout << "Hash size set to " << TT.size_mb() << "MB\n";
+                } else {
+                    std::cout << "Hash size must be between 1 and 65536MB\n";
+                }
+            } catch (...) {
+                std::cout << "Invalid hash size\n";
+            }
+            
+        } else if (command == "clearhash") {
+            TT.clear();
+            std::cout << "Hash cleared\n";
+            
         } else if (command.substr(0, 3) == "fen") {
             std::string fen = command.substr(4);
             try {
@@ -202,10 +253,45 @@ int main() {
                 std::cout << "Position is equal\n";
             }
             
+        } else if (command.substr(0, 3) == "see") {
+            std::string move_str = command.length() > 4 ? command.substr(4) : "";
+            if (!board.is_valid_move(move_str)) {
+                std::cout << "Invalid move: " << move_str << "\n";
+                continue;
+            }
+            std::cout << "SEE of " << move_str << ": " << Eval::see(board, board.parse_move(move_str))
+                      << " centipawns\n";
+            
+        } else if (command == "bench") {
+            Bench::run();
+            
+        } else if (command.substr(0, 5) == "perft" || command.substr(0, 6) == "divide") {
+            // perft <depth> [threads] [hash MB]
+            bool divide = command.substr(0, 6) == "divide";
+            try {
+                std::istringstream args(command.substr(divide ? 7 : 6));
+                int depth = 0, threads = 1, hash_mb = 0;
+                args >> depth;
+                if (!(args >> threads)) threads = 1;
+                if (!(args >> hash_mb)) hash_mb = 0;
+                if (depth <= 0 || depth > 10) {
+                    std::cout << "Depth must be between 1 and 10\n";
+                } else if (threads < 1 || threads > 256 || hash_mb < 0) {
+                    std::cout << "Usage: " << (divide ? "divide" : "perft") << " <depth> [threads] [hash MB]\n";
+                } else if (divide) {
+                    Perft::divide(board, depth, threads, hash_mb);
+                } else {
+                    Perft::run(board, depth, threads, hash_mb);
+                }
+            } catch (...) {
+                std::cout << "Invalid depth value\n";
+            }
+            
         } else if (command == "legal") {
-            std::vector<Move> legal_moves = board.generate_legal_moves();
+            MoveList legal_moves;
+            board.generate_legal_moves(legal_moves);
             std::cout << "Legal moves (" << legal_moves.size() << "): ";
-            for (size_t i = 0; i < legal_moves.size(); i++) {
+            for (int i = 0; i < legal_moves.size(); i++) {
                 std::cout << legal_moves[i].to_string();
                 if (i < legal_moves.size() - 1) std::cout << ", ";
             }
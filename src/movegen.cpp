@@ -1,291 +1,346 @@
 #include "movegen.h"
 #include "bitboard.h"
-#include <iostream>
 
 namespace MoveGen {
 
-std::vector<Move> generate_moves(const Board& board) {
-    std::vector<Move> moves;
-    Color color = board.get_side_to_move();
-    
-    std::vector<Move> pawn_moves = generate_pawn_moves(board, color);
-    moves.insert(moves.end(), pawn_moves.begin(), pawn_moves.end());
-    
-    std::vector<Move> knight_moves = generate_knight_moves(board, color);
-    moves.insert(moves.end(), knight_moves.begin(), knight_moves.end());
-    
-    std::vector<Move> bishop_moves = generate_bishop_moves(board, color);
-    moves.insert(moves.end(), bishop_moves.begin(), bishop_moves.end());
-    
-    std::vector<Move> rook_moves = generate_rook_moves(board, color);
-    moves.insert(moves.end(), rook_moves.begin(), rook_moves.end());
-    
-    std::vector<Move> queen_moves = generate_queen_moves(board, color);
-    moves.insert(moves.end(), queen_moves.begin(), queen_moves.end());
-    
-    std::vector<Move> king_moves = generate_king_moves(board, color);
-    moves.insert(moves.end(), king_moves.begin(), king_moves.end());
-    
-    std::vector<Move> castling_moves = generate_castling_moves(board, color);
-    moves.insert(moves.end(), castling_moves.begin(), castling_moves.end());
-    
-    return moves;
-}
+// What the generator does with the moves it finds
+enum LegalMode {
+    LEGAL_GENERATE, // append them to the list
+    LEGAL_COUNT,    // count them, using popcount where a whole set is legal
+    LEGAL_ANY       // stop at the first one
+};
 
-std::vector<Move> generate_captures(const Board& board) {
-    std::vector<Move> moves = generate_moves(board);
-    std::vector<Move> captures;
-    
-    for (const Move& move : moves) {
-        if (move.is_capture()) {
-            captures.push_back(move);
-        }
-    }
-    
-    return captures;
-}
+// Which moves to produce
+enum GenType {
+    GEN_ALL,          // every legal move
+    GEN_TACTICAL,     // captures, en passant and queen promotions, for quiescence
+    GEN_QUIET,        // everything else: quiet moves, castling and underpromotions
+    GEN_PSEUDO_LEGAL  // every move, without checking pins or checks
+};
+
+// Facts about the position shared by every piece type's generator
+struct GenContext {
+    Square ksq;           // our king, SQUARE_NONE if there is none
+    Bitboard occupied;
+    Bitboard own_pieces;
+    Bitboard enemy_pieces;
+    Bitboard target;      // destinations allowed by check evasion
+    Bitboard pinned;      // our pieces pinned to our king
+};
 
-std::vector<Move> generate_pawn_moves(const Board& board, Color color) {
-    std::vector<Move> moves;
-    Bitboard pawns = board.get_pieces(color, PAWN);
+// Pieces of color Us pinned to the king on ksq by an enemy slider
+template <Color Us>
+static Bitboard pinned_pieces(const Board& board, Square ksq) {
+    constexpr Color Them = (Us == WHITE) ? BLACK : WHITE;
     Bitboard occupied = board.get_occupied();
-    Bitboard enemy_pieces = board.get_all_pieces((color == WHITE) ? BLACK : WHITE);
-    Bitboard empty = ~occupied;
+    Bitboard queens = board.get_pieces(Them, QUEEN);
     
-    // Pawn push direction
-    int push_dir = (color == WHITE) ? 8 : -8;
-    Bitboard push_targets = (color == WHITE) ? (pawns << 8) & empty : (pawns >> 8) & empty;
+    // Enemy sliders that would hit the king on an empty board
+    Bitboard snipers = (rook_attacks(ksq, 0) & (board.get_pieces(Them, ROOK) | queens))
+                     | (bishop_attacks(ksq, 0) & (board.get_pieces(Them, BISHOP) | queens));
     
-    // Single pawn pushes
-    Bitboard single_pushes = push_targets;
-    while (single_pushes) {
-        Bitboard push = BitboardUtils::pop_lsb(single_pushes);
-        Square to = Square(BitboardUtils::lsb(push));
-        Square from = Square(to - push_dir);
+    Bitboard pinned = 0;
+    while (snipers) {
+        Square sniper = BitboardUtils::pop_lsb(snipers);
+        Bitboard blockers = BETWEEN_BB[ksq][sniper] & occupied;
         
-        // Check for promotion
-        if ((color == WHITE && BitboardUtils::rank_of(to) == 7) ||
-            (color == BLACK && BitboardUtils::rank_of(to) == 0)) {
-            add_promotion_moves(moves, from, to, false);
-        } else {
-            moves.emplace_back(from, to, Move::NORMAL);
+        // Exactly one piece in the way, and it is ours
+        if (blockers && !(blockers & (blockers - 1))) {
+            pinned |= blockers & board.get_all_pieces(Us);
         }
     }
-    
-    // Double pawn pushes
-    Bitboard double_push_targets = (color == WHITE) ? 
-        (push_targets << 8) & empty & RANK_BB[3] :
-        (push_targets >> 8) & empty & RANK_BB[4];
-    
-    while (double_push_targets) {
-        Bitboard push = BitboardUtils::pop_lsb(double_push_targets);
-        Square to = Square(BitboardUtils::lsb(push));
-        Square from = Square(to - 2 * push_dir);
-        moves.emplace_back(from, to, Move::DOUBLE_PAWN_PUSH);
+    return pinned;
+}
+
+// Emit one move per target square, or just count them
+template <LegalMode Mode>
+static int add_moves(Square from, Bitboard targets, Bitboard enemy_pieces, MoveList* moves) {
+    if (Mode != LEGAL_GENERATE) {
+        return BitboardUtils::popcount(targets);
     }
-    
-    // Pawn captures
-    Bitboard pawns_copy = pawns;
-    while (pawns_copy) {
-        Bitboard pawn = BitboardUtils::pop_lsb(pawns_copy);
-        Square from = Square(BitboardUtils::lsb(pawn));
-        Bitboard attacks = PAWN_ATTACKS[color][from] & enemy_pieces;
-        
-        while (attacks) {
-            Bitboard attack = BitboardUtils::pop_lsb(attacks);
-            Square to = Square(BitboardUtils::lsb(attack));
-            
-            // Check for promotion
-            if ((color == WHITE && BitboardUtils::rank_of(to) == 7) ||
-                (color == BLACK && BitboardUtils::rank_of(to) == 0)) {
-                add_promotion_moves(moves, from, to, true);
-            } else {
-                moves.emplace_back(from, to, Move::CAPTURE);
-            }
-        }
+    int count = 0;
+    while (targets) {
+        Square to = BitboardUtils::pop_lsb(targets);
+        moves->emplace_back(from, to, test_bit(enemy_pieces, to) ? Move::CAPTURE : Move::NORMAL);
+        count++;
     }
-    
-    // En passant captures
-    Square ep_square = board.get_state().en_passant_square;
-    if (ep_square != SQUARE_NONE) {
-        Bitboard ep_attackers = PAWN_ATTACKS[color][ep_square] & pawns;
-        while (ep_attackers) {
-            Bitboard attacker = BitboardUtils::pop_lsb(ep_attackers);
-            Square from = Square(BitboardUtils::lsb(attacker));
-            moves.emplace_back(from, ep_square, Move::EN_PASSANT);
-        }
-    }
-    
-    return moves;
+    return count;
 }
 
-std::vector<Move> generate_knight_moves(const Board& board, Color color) {
-    std::vector<Move> moves;
-    Bitboard knights = board.get_pieces(color, KNIGHT);
-    Bitboard occupied = board.get_occupied();
-    Bitboard own_pieces = board.get_all_pieces(color);
-    Bitboard enemy_pieces = board.get_all_pieces((color == WHITE) ? BLACK : WHITE);
-    
-    while (knights) {
-        Bitboard knight = BitboardUtils::pop_lsb(knights);
-        Square from = Square(BitboardUtils::lsb(knight));
-        Bitboard attacks = KNIGHT_ATTACKS[from] & ~own_pieces;
-        
-        while (attacks) {
-            Bitboard attack = BitboardUtils::pop_lsb(attacks);
-            Square to = Square(BitboardUtils::lsb(attack));
-            Move::Type type = (enemy_pieces & attack) ? Move::CAPTURE : Move::NORMAL;
-            moves.emplace_back(from, to, type);
-        }
+// Knight, bishop, rook or queen moves. A pinned piece may only move along
+// the line through the king and its pinner, so pinned knights never move.
+template <Color Us, Piece Pt, GenType Type, LegalMode Mode>
+static int generate_piece_moves(const Board& board, const GenContext& ctx, MoveList* moves) {
+    // Tactical moves all capture, and quiet moves never do
+    Bitboard targets_mask = (Type == GEN_TACTICAL) ? ctx.enemy_pieces :
+                            (Type == GEN_QUIET) ? ~ctx.occupied : ~ctx.own_pieces;
+    targets_mask &= ctx.target;
+    
+    Bitboard pieces = board.get_pieces(Us, Pt);
+    if (Pt == KNIGHT) pieces &= ~ctx.pinned;
+    
+    int count = 0;
+    while (pieces) {
+        Square from = BitboardUtils::pop_lsb(pieces);
+        Bitboard attacks = BitboardUtils::get_attacks(Pt, from, Us, ctx.occupied) & targets_mask;
+        if (Pt != KNIGHT && test_bit(ctx.pinned, from)) attacks &= LINE_BB[ctx.ksq][from];
+        count += add_moves<Mode>(from, attacks, ctx.enemy_pieces, moves);
     }
-    
-    return moves;
+    return count;
 }
 
-std::vector<Move> generate_bishop_moves(const Board& board, Color color) {
-    std::vector<Move> moves;
-    Bitboard bishops = board.get_pieces(color, BISHOP);
-    Bitboard occupied = board.get_occupied();
-    Bitboard own_pieces = board.get_all_pieces(color);
-    Bitboard enemy_pieces = board.get_all_pieces((color == WHITE) ? BLACK : WHITE);
-    
-    while (bishops) {
-        Bitboard bishop = BitboardUtils::pop_lsb(bishops);
-        Square from = Square(BitboardUtils::lsb(bishop));
-        Bitboard attacks = BitboardUtils::get_attacks(BISHOP, from, color, occupied) & ~own_pieces;
-        
-        while (attacks) {
-            Bitboard attack = BitboardUtils::pop_lsb(attacks);
-            Square to = Square(BitboardUtils::lsb(attack));
-            Move::Type type = (enemy_pieces & attack) ? Move::CAPTURE : Move::NORMAL;
-            moves.emplace_back(from, to, type);
-        }
+// Emit the pawn moves onto every square of targets, each coming from
+// Delta squares behind its target
+template <int Delta, LegalMode Mode>
+static int add_pawn_moves(Bitboard targets, Move::Type type, MoveList* moves) {
+    if (Mode != LEGAL_GENERATE) {
+        return BitboardUtils::popcount(targets);
     }
-    
-    return moves;
+    int count = 0;
+    while (targets) {
+        Square to = BitboardUtils::pop_lsb(targets);
+        moves->emplace_back(Square(to - Delta), to, type);
+        count++;
+    }
+    return count;
 }
 
-std::vector<Move> generate_rook_moves(const Board& board, Color color) {
-    std::vector<Move> moves;
-    Bitboard rooks = board.get_pieces(color, ROOK);
-    Bitboard occupied = board.get_occupied();
-    Bitboard own_pieces = board.get_all_pieces(color);
-    Bitboard enemy_pieces = board.get_all_pieces((color == WHITE) ? BLACK : WHITE);
-    
-    while (rooks) {
-        Bitboard rook = BitboardUtils::pop_lsb(rooks);
-        Square from = Square(BitboardUtils::lsb(rook));
-        Bitboard attacks = BitboardUtils::get_attacks(ROOK, from, color, occupied) & ~own_pieces;
-        
-        while (attacks) {
-            Bitboard attack = BitboardUtils::pop_lsb(attacks);
-            Square to = Square(BitboardUtils::lsb(attack));
-            Move::Type type = (enemy_pieces & attack) ? Move::CAPTURE : Move::NORMAL;
-            moves.emplace_back(from, to, type);
+// Promotions onto every square of targets: the queen promotion is
+// tactical, the underpromotions are quiet
+template <int Delta, GenType Type, LegalMode Mode>
+static int add_pawn_promotions(Bitboard targets, bool is_capture, MoveList* moves) {
+    constexpr Piece first = (Type == GEN_QUIET) ? ROOK : QUEEN;
+    constexpr Piece last = (Type == GEN_TACTICAL) ? QUEEN : KNIGHT;
+    
+    if (Mode != LEGAL_GENERATE) {
+        return BitboardUtils::popcount(targets) * (first - last + 1);
+    }
+    int count = 0;
+    Move::Type type = is_capture ? Move::PROMOTION_CAPTURE : Move::PROMOTION;
+    while (targets) {
+        Square to = BitboardUtils::pop_lsb(targets);
+        for (Piece promo = first; promo >= last; promo = Piece(promo - 1)) {
+            moves->emplace_back(Square(to - Delta), to, type, promo);
+            count++;
         }
     }
-    
-    return moves;
+    return count;
 }
 
-std::vector<Move> generate_queen_moves(const Board& board, Color color) {
-    std::vector<Move> moves;
-    Bitboard queens = board.get_pieces(color, QUEEN);
-    Bitboard occupied = board.get_occupied();
-    Bitboard own_pieces = board.get_all_pieces(color);
-    Bitboard enemy_pieces = board.get_all_pieces((color == WHITE) ? BLACK : WHITE);
+// Pawn moves, set-wise: each kind of move is one shift of the pawns that
+// can make it
+template <Color Us, GenType Type, LegalMode Mode>
+static int generate_pawn_moves(const Board& board, const GenContext& ctx, MoveList* moves) {
+    constexpr int Up = (Us == WHITE) ? 8 : -8;
+    constexpr int UpWest = (Us == WHITE) ? 7 : -9;
+    constexpr int UpEast = (Us == WHITE) ? 9 : -7;
+    constexpr Rank Rank7 = (Us == WHITE) ? RANK_7 : RANK_2;
+    constexpr Rank Rank3 = (Us == WHITE) ? RANK_3 : RANK_6;
+    
+    Bitboard pawns = board.get_pieces(Us, PAWN);
+    Bitboard empty = ~ctx.occupied;
+    Bitboard enemies = ctx.enemy_pieces & ctx.target;
+    
+    // A pinned pawn keeps to its pin line: it can push only when pinned
+    // along its file, and capture only onto the pin line's diagonal
+    Bitboard pushers = pawns & ~ctx.pinned;
+    Bitboard west_capturers = pushers;
+    Bitboard east_capturers = pushers;
+    Bitboard pinned_pawns = pawns & ctx.pinned;
+    while (pinned_pawns) {
+        Square from = BitboardUtils::pop_lsb(pinned_pawns);
+        Bitboard line = LINE_BB[ctx.ksq][from];
+        if (line & shift_bb<Up>(square_bb(from))) set_bit(pushers, from);
+        if (line & shift_bb<UpWest>(square_bb(from))) set_bit(west_capturers, from);
+        if (line & shift_bb<UpEast>(square_bb(from))) set_bit(east_capturers, from);
+    }
     
-    while (queens) {
-        Bitboard queen = BitboardUtils::pop_lsb(queens);
-        Square from = Square(BitboardUtils::lsb(queen));
-        Bitboard attacks = BitboardUtils::get_attacks(QUEEN, from, color, occupied) & ~own_pieces;
-        
-        while (attacks) {
-            Bitboard attack = BitboardUtils::pop_lsb(attacks);
-            Square to = Square(BitboardUtils::lsb(attack));
-            Move::Type type = (enemy_pieces & attack) ? Move::CAPTURE : Move::NORMAL;
-            moves.emplace_back(from, to, type);
-        }
+    int count = 0;
+    
+    if (Type != GEN_TACTICAL) {
+        Bitboard single = shift_bb<Up>(pushers & ~RANK_BB[Rank7]) & empty;
+        Bitboard double_push = shift_bb<Up>(single & RANK_BB[Rank3]) & empty;
+        count += add_pawn_moves<Up, Mode>(single & ctx.target, Move::NORMAL, moves);
+        count += add_pawn_moves<Up + Up, Mode>(double_push & ctx.target, Move::DOUBLE_PAWN_PUSH, moves);
     }
     
-    return moves;
-}
-
-std::vector<Move> generate_king_moves(const Board& board, Color color) {
-    std::vector<Move> moves;
-    Bitboard kings = board.get_pieces(color, KING);
-    Bitboard occupied = board.get_occupied();
-    Bitboard own_pieces = board.get_all_pieces(color);
-    Bitboard enemy_pieces = board.get_all_pieces((color == WHITE) ? BLACK : WHITE);
+    if (Type != GEN_QUIET) {
+        count += add_pawn_moves<UpWest, Mode>(shift_bb<UpWest>(west_capturers & ~RANK_BB[Rank7]) & enemies, Move::CAPTURE, moves);
+        count += add_pawn_moves<UpEast, Mode>(shift_bb<UpEast>(east_capturers & ~RANK_BB[Rank7]) & enemies, Move::CAPTURE, moves);
+    }
     
-    while (kings) {
-        Bitboard king = BitboardUtils::pop_lsb(kings);
-        Square from = Square(BitboardUtils::lsb(king));
-        Bitboard attacks = KING_ATTACKS[from] & ~own_pieces;
-        
-        while (attacks) {
-            Bitboard attack = BitboardUtils::pop_lsb(attacks);
-            Square to = Square(BitboardUtils::lsb(attack));
-            Move::Type type = (enemy_pieces & attack) ? Move::CAPTURE : Move::NORMAL;
-            moves.emplace_back(from, to, type);
+    if (pawns & RANK_BB[Rank7]) {
+        count += add_pawn_promotions<Up, Type, Mode>(shift_bb<Up>(pushers & RANK_BB[Rank7]) & empty & ctx.target, false, moves);
+        count += add_pawn_promotions<UpWest, Type, Mode>(shift_bb<UpWest>(west_capturers & RANK_BB[Rank7]) & enemies, true, moves);
+        count += add_pawn_promotions<UpEast, Type, Mode>(shift_bb<UpEast>(east_capturers & RANK_BB[Rank7]) & enemies, true, moves);
+    }
+    
+    // En passant removes two pieces from one rank, which the pin mask cannot
+    // describe, so each candidate is checked against the resulting occupancy
+    Square ep_square = board.get_state().en_passant_square;
+    if (Type != GEN_QUIET && ep_square != SQUARE_NONE) {
+        constexpr Color Them = (Us == WHITE) ? BLACK : WHITE;
+        Square captured = Square(ep_square - Up);
+        Bitboard ep_attackers = PAWN_ATTACKS[Them][ep_square] & pawns;
+        while (ep_attackers) {
+            Square from = BitboardUtils::pop_lsb(ep_attackers);
+            Bitboard occupied_after = (ctx.occupied ^ square_bb(from) ^ square_bb(captured)) | square_bb(ep_square);
+            if (Type == GEN_PSEUDO_LEGAL || ctx.ksq == SQUARE_NONE ||
+                !(board.attackers_to(ctx.ksq, occupied_after) & ctx.enemy_pieces & ~square_bb(captured))) {
+                if (Mode == LEGAL_GENERATE) moves->emplace_back(from, ep_square, Move::EN_PASSANT);
+                count++;
+            }
         }
     }
     
-    return moves;
+    return count;
 }
 
-std::vector<Move> generate_castling_moves(const Board& board, Color color) {
-    std::vector<Move> moves;
+// Castling: the king may not be in check (checked by the caller), the
+// squares between king and rook must be empty and those the king crosses
+// unattacked
+template <Color Us, LegalMode Mode>
+static int generate_castling_moves(const Board& board, const GenContext& ctx, MoveList* moves) {
+    constexpr Square king_from = (Us == WHITE) ? E1 : E8;
     const GameState& state = board.get_state();
     
-    // Check if king is in check
-    if (board.is_in_check(color)) {
-        return moves;
-    }
+    auto safe = [&](Square sq) {
+        return !(board.attackers_to(sq, ctx.occupied) & ctx.enemy_pieces);
+    };
     
-    Bitboard occupied = board.get_occupied();
+    // A castling right read from a FEN does not guarantee the rook is home
+    Bitboard rooks = board.get_pieces(Us, ROOK);
+    
+    int count = 0;
     
     // Kingside castling
-    if (state.castling_rights[color][1]) {
-        Square king_square = (color == WHITE) ? E1 : E8;
-        Square rook_square = (color == WHITE) ? H1 : H8;
-        Square king_to = (color == WHITE) ? G1 : G8;
-        Square rook_to = (color == WHITE) ? F1 : F8;
-        
-        // Check if squares are empty and not attacked
-        Bitboard castling_squares = square_bb(king_to) | square_bb(rook_to);
-        if (!(occupied & castling_squares) && 
-            !BitboardUtils::is_attacked(king_to, (color == WHITE) ? BLACK : WHITE, board.get_pieces_array()) &&
-            !BitboardUtils::is_attacked(rook_to, (color == WHITE) ? BLACK : WHITE, board.get_pieces_array())) {
-            moves.emplace_back(king_square, king_to, Move::KING_CASTLE);
-        }
+    constexpr Square f_square = (Us == WHITE) ? F1 : F8;
+    constexpr Square g_square = (Us == WHITE) ? G1 : G8;
+    constexpr Square h_square = (Us == WHITE) ? H1 : H8;
+    if (state.castling_rights[Us][1] && (rooks & square_bb(h_square)) &&
+        !(ctx.occupied & (square_bb(f_square) | square_bb(g_square))) &&
+        safe(f_square) && safe(g_square)) {
+        if (Mode == LEGAL_GENERATE) moves->emplace_back(king_from, g_square, Move::KING_CASTLE);
+        count++;
     }
     
     // Queenside castling
-    if (state.castling_rights[color][0]) {
-        Square king_square = (color == WHITE) ? E1 : E8;
-        Square rook_square = (color == WHITE) ? A1 : A8;
-        Square king_to = (color == WHITE) ? C1 : C8;
-        Square rook_to = (color == WHITE) ? D1 : D8;
-        
-        // Check if squares are empty and not attacked
-        Bitboard castling_squares = square_bb(king_to) | square_bb(rook_to) | square_bb((color == WHITE) ? B1 : B8);
-        if (!(occupied & castling_squares) && 
-            !BitboardUtils::is_attacked(king_to, (color == WHITE) ? BLACK : WHITE, board.get_pieces_array()) &&
-            !BitboardUtils::is_attacked(rook_to, (color == WHITE) ? BLACK : WHITE, board.get_pieces_array())) {
-            moves.emplace_back(king_square, king_to, Move::QUEEN_CASTLE);
-        }
+    constexpr Square b_square = (Us == WHITE) ? B1 : B8;
+    constexpr Square c_square = (Us == WHITE) ? C1 : C8;
+    constexpr Square d_square = (Us == WHITE) ? D1 : D8;
+    constexpr Square a_square = (Us == WHITE) ? A1 : A8;
+    if (state.castling_rights[Us][0] && (rooks & square_bb(a_square)) &&
+        !(ctx.occupied & (square_bb(b_square) | square_bb(c_square) | square_bb(d_square))) &&
+        safe(c_square) && safe(d_square)) {
+        if (Mode == LEGAL_GENERATE) moves->emplace_back(king_from, c_square, Move::QUEEN_CASTLE);
+        count++;
     }
     
-    return moves;
+    return count;
 }
 
-void add_promotion_moves(std::vector<Move>& moves, Square from, Square to, bool is_capture) {
-    Move::Type base_type = is_capture ? Move::PROMOTION_CAPTURE : Move::PROMOTION;
+// Move generation, counting and existence test share one walk so they
+// cannot disagree. Returns the number of moves found (in LEGAL_ANY mode, a
+// positive count as soon as one is found); moves is only used in
+// LEGAL_GENERATE mode.
+template <Color Us, GenType Type, LegalMode Mode>
+static int generate(const Board& board, MoveList* moves) {
+    constexpr Color Them = (Us == WHITE) ? BLACK : WHITE;
+    constexpr bool Legal = (Type != GEN_PSEUDO_LEGAL);
+    
+    Bitboard king = board.get_pieces(Us, KING);
+    
+    GenContext ctx;
+    ctx.ksq = king ? BitboardUtils::lsb(king) : SQUARE_NONE;
+    ctx.occupied = board.get_occupied();
+    ctx.own_pieces = board.get_all_pieces(Us);
+    ctx.enemy_pieces = board.get_all_pieces(Them);
+    ctx.target = FULL_BB;
+    ctx.pinned = 0;
+    
+    // Without a king nothing can be left in check
+    Bitboard checkers = king ? board.attackers_to(ctx.ksq, ctx.occupied) & ctx.enemy_pieces : 0;
+    
+    int count = 0;
+    
+    // King moves: the king is lifted off the board so sliders see through
+    // the square it is leaving
+    if (king) {
+        Bitboard king_targets = KING_ATTACKS[ctx.ksq] & (Type == GEN_TACTICAL ? ctx.enemy_pieces :
+                                                         Type == GEN_QUIET ? ~ctx.occupied : ~ctx.own_pieces);
+        if (Legal) {
+            Bitboard occupied_without_king = ctx.occupied ^ king;
+            Bitboard candidates = king_targets;
+            while (candidates) {
+                Square to = BitboardUtils::pop_lsb(candidates);
+                if (board.attackers_to(to, occupied_without_king) & ctx.enemy_pieces) {
+                    clear_bit(king_targets, to);
+                }
+            }
+        }
+        count += add_moves<Mode>(ctx.ksq, king_targets, ctx.enemy_pieces, moves);
+        if (Mode == LEGAL_ANY && count) return count;
+    }
     
-    for (Piece promo = QUEEN; promo >= KNIGHT; promo = Piece(promo - 1)) {
-        moves.emplace_back(from, to, base_type, promo);
+    if (Legal && king) {
+        // In double check only the king can move
+        if (checkers & (checkers - 1)) {
+            return count;
+        }
+        
+        // Other moves must capture the checker or block its line
+        if (checkers) {
+            Square checker = BitboardUtils::lsb(checkers);
+            ctx.target = BETWEEN_BB[ctx.ksq][checker] | checkers;
+        }
+        
+        ctx.pinned = pinned_pieces<Us>(board, ctx.ksq);
+    }
+    
+    count += generate_piece_moves<Us, KNIGHT, Type, Mode>(board, ctx, moves);
+    count += generate_piece_moves<Us, BISHOP, Type, Mode>(board, ctx, moves);
+    count += generate_piece_moves<Us, ROOK, Type, Mode>(board, ctx, moves);
+    count += generate_piece_moves<Us, QUEEN, Type, Mode>(board, ctx, moves);
+    if (Mode == LEGAL_ANY && count) return count;
+    
+    count += generate_pawn_moves<Us, Type, Mode>(board, ctx, moves);
+    
+    if (Type != GEN_TACTICAL && king && !checkers) {
+        count += generate_castling_moves<Us, Mode>(board, ctx, moves);
     }
+    
+    return count;
+}
+
+// Instantiate for the side to move
+template <GenType Type, LegalMode Mode>
+static int generate(const Board& board, MoveList* moves) {
+    return board.get_side_to_move() == WHITE ? generate<WHITE, Type, Mode>(board, moves)
+                                             : generate<BLACK, Type, Mode>(board, moves);
+}
+
+void generate_moves(const Board& board, MoveList& moves) {
+    generate<GEN_PSEUDO_LEGAL, LEGAL_GENERATE>(board, &moves);
+}
+
+void generate_legal_moves(const Board& board, MoveList& moves) {
+    generate<GEN_ALL, LEGAL_GENERATE>(board, &moves);
+}
+
+int count_legal_moves(const Board& board) {
+    return generate<GEN_ALL, LEGAL_COUNT>(board, nullptr);
+}
+
+bool has_any_legal_move(const Board& board) {
+    return generate<GEN_ALL, LEGAL_ANY>(board, nullptr) > 0;
+}
+
+void generate_tactical_moves(const Board& board, MoveList& moves) {
+    generate<GEN_TACTICAL, LEGAL_GENERATE>(board, &moves);
+}
+
+void generate_quiet_moves(const Board& board, MoveList& moves) {
+    generate<GEN_QUIET, LEGAL_GENERATE>(board, &moves);
 }
 
-} // namespace MoveGen 
\ No newline at end of file
+} // namespace MoveGen
@@ -1,27 +1,29 @@
 #pragma once
 #include "board.h"
-#include <vector>
 
 namespace MoveGen {
-    // Generate all pseudo-legal moves
-    std::vector<Move> generate_moves(const Board& board);
+    // Generators are templated on the side to move and the kind of moves
+    // wanted, so each combination compiles to straight-line code.
     
-    // Generate only capture moves
-    std::vector<Move> generate_captures(const Board& board);
+    // Generate all pseudo-legal moves, appending to moves
+    void generate_moves(const Board& board, MoveList& moves);
     
-    // Generate moves for specific piece types
-    std::vector<Move> generate_pawn_moves(const Board& board, Color color);
-    std::vector<Move> generate_knight_moves(const Board& board, Color color);
-    std::vector<Move> generate_bishop_moves(const Board& board, Color color);
-    std::vector<Move> generate_rook_moves(const Board& board, Color color);
-    std::vector<Move> generate_queen_moves(const Board& board, Color color);
-    std::vector<Move> generate_king_moves(const Board& board, Color color);
+    // Generate only legal moves. Checkers and pins are found once up front,
+    // so only king moves and en passant need an attack test per move.
+    void generate_legal_moves(const Board& board, MoveList& moves);
     
-    // Generate castling moves
-    std::vector<Move> generate_castling_moves(const Board& board, Color color);
+    // Number of legal moves, without building the list
+    int count_legal_moves(const Board& board);
     
-    // Utility functions
-    void add_pawn_moves(std::vector<Move>& moves, Square from, Bitboard targets, Color color);
-    void add_promotion_moves(std::vector<Move>& moves, Square from, Square to, bool is_capture);
-    void add_castling_move(std::vector<Move>& moves, Square king_from, Square king_to, Square rook_from, Square rook_to);
-} 
\ No newline at end of file
+    // Whether the side to move has a legal move; stops at the first one found
+    bool has_any_legal_move(const Board& board);
+    
+    // Generate the legal captures, en passant captures and queen promotions
+    // (quiescence moves), without generating quiet moves first
+    void generate_tactical_moves(const Board& board, MoveList& moves);
+    
+    // Generate the remaining legal moves: quiet moves, castling and
+    // underpromotions. Together with the tactical moves these are exactly
+    // the legal moves.
+    void generate_quiet_moves(const Board& board, MoveList& moves);
+} 
@@ -0,0 +1,172 @@
+#include "movepick.h"
+#include "eval.h"
+#include <utility>
+
+MovePicker::MovePicker(const Board& board, Move hash_move, const Move killers[2], Move counter_move,
+                       const ButterflyHistory* history)
+    : board(board), history(history), hash_move(hash_move), stage(HASH_MOVE), current(0), bad_captures_end(0),
+      refutation_index(0) {
+    // Duplicates are nulled so no move is returned twice
+    refutations[0] = killers ? killers[0] : Move();
+    refutations[1] = (killers && killers[1] != refutations[0]) ? killers[1] : Move();
+    refutations[2] = (counter_move != refutations[0] && counter_move != refutations[1]) ? counter_move : Move();
+}
+
+MovePicker::MovePicker(const Board& board)
+    : board(board), history(nullptr), hash_move(), stage(QSEARCH_GENERATE), current(0), bad_captures_end(0),
+      refutation_index(0) {
+    for (Move& refutation : refutations) {
+        refutation = Move();
+    }
+}
+
+Move MovePicker::next_move() {
+    switch (stage) {
+        case HASH_MOVE:
+            stage = GENERATE_CAPTURES;
+            if (board.is_pseudo_legal(hash_move) && board.is_legal(hash_move)) {
+                return hash_move;
+            }
+            // Fall through
+            
+        case GENERATE_CAPTURES:
+            board.generate_tactical_moves(moves);
+            score_captures();
+            stage = GOOD_CAPTURES;
+            // Fall through
+            
+        case GOOD_CAPTURES:
+            while (current < moves.size()) {
+                Move move = pick_best();
+                current++;
+                if (move == hash_move) continue;
+                
+                // Set losing captures aside in the slots already picked
+                if (Eval::see(board, move) < 0) {
+                    moves[bad_captures_end++] = moves[current - 1];
+                    continue;
+                }
+                return move;
+            }
+            stage = REFUTATIONS;
+            // Fall through
+            
+        case REFUTATIONS:
+            while (refutation_index < 3) {
+                Move& refutation = refutations[refutation_index++];
+                
+                // Only quiet refutations count: tactical moves were searched
+                // above. Refutations not played here are cleared so the
+                // quiet stage does not skip them.
+                bool tactical = refutation.is_promotion() ? refutation.promotion() == QUEEN : refutation.is_capture();
+                if (refutation != hash_move && !tactical &&
+                    board.is_pseudo_legal(refutation) && board.is_legal(refutation)) {
+                    return refutation;
+                }
+                refutation = Move();
+            }
+            stage = GENERATE_QUIETS;
+            // Fall through
+            
+        case GENERATE_QUIETS:
+            current = moves.size();
+            board.generate_quiet_moves(moves);
+            score_quiets(current);
+            stage = QUIETS;
+            // Fall through
+            
+        case QUIETS:
+            while (current < moves.size()) {
+                Move move = pick_best();
+                current++;
+                if (!is_special(move)) {
+                    return move;
+                }
+            }
+            current = 0;
+            stage = BAD_CAPTURES;
+            // Fall through
+            
+        case BAD_CAPTURES:
+            // Already in best-first order from the good capture stage
+            if (current < bad_captures_end) {
+                return moves[current++];
+            }
+            stage = DONE;
+            return Move();
+            
+        case QSEARCH_GENERATE:
+            board.generate_tactical_moves(moves);
+            score_captures();
+            stage = QSEARCH_CAPTURES;
+            // Fall through
+            
+        case QSEARCH_CAPTURES:
+            if (current < moves.size()) {
+                Move move = pick_best();
+                current++;
+                return move;
+            }
+            stage = DONE;
+            return Move();
+            
+        case DONE:
+            return Move();
+    }
+    return Move();
+}
+
+void MovePicker::score_captures() {
+    for (ScoredMove& move : moves) {
+        // MVV-LVA: most valuable victim first, then least valuable attacker
+        Piece victim = move.type() == Move::EN_PASSANT ? PAWN : board.get_piece(move.to());
+        move.score = Eval::get_piece_value(victim) * 10 - Eval::get_piece_value(board.get_piece(move.from()));
+        if (move.is_promotion()) {
+            move.score += Eval::get_piece_value(move.promotion()) * 8;
+        }
+    }
+}
+
+void MovePicker::score_quiets(int begin) {
+    Color us = board.get_side_to_move();
+    for (int i = begin; i < moves.size(); i++) {
+        ScoredMove& move = moves[i];
+        int score = history ? (*history)[us][move.from()][move.to()] : 0;
+        
+        // Underpromotions
+        if (move.is_promotion()) {
+            score += Eval::get_piece_value(move.promotion()) * 8;
+        }
+        
+        // Castling gets medium priority
+        if (move.is_castle()) {
+            score += 50;
+        }
+        
+        // Pawn pushes to center get some priority
+        if (board.get_piece(move.from()) == PAWN) {
+            int to_rank = BitboardUtils::rank_of(move.to());
+            int to_file = BitboardUtils::file_of(move.to());
+            if (to_file >= 2 && to_file <= 5 && to_rank >= 3 && to_rank <= 4) {
+                score += 10;
+            }
+        }
+        
+        move.score = score;
+    }
+}
+
+const ScoredMove& MovePicker::pick_best() {
+    int best = current;
+    for (int i = current + 1; i < moves.size(); i++) {
+        if (moves[i].score > moves[best].score) {
+            best = i;
+        }
+    }
+    std::swap(moves[current], moves[best]);
+    return moves[current];
+}
+
+bool MovePicker::is_special(const Move& move) const {
+    return move == hash_move || move == refutations[0] || move == refutations[1] || move == refutations[2];
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "board.h"
+
+// Quiet move history by [color][from][to]: raised for quiet moves that
+// cause a beta cutoff and lowered for the quiet moves searched before them
+using ButterflyHistory = int[2][64][64];
+
+// Staged move picker. Moves come out one at a time in the order the search
+// wants to try them, and each stage is only generated once the earlier ones
+// have failed to produce a cutoff:
+//   hash move, good captures (best first), killers and the counter-move,
+//   quiet moves (by history), losing captures (negative static exchange)
+// Selection is by partial selection sort: each call scans the remaining
+// moves for the best one, which beats a full sort when a cutoff comes early.
+class MovePicker {
+public:
+    // Main search. hash_move, killers and counter_move (the move that last
+    // refuted the opponent's previous move) may be null moves; they are only
+    // played if legal in this position, and never twice. history may be null.
+    MovePicker(const Board& board, Move hash_move, const Move killers[2], Move counter_move,
+               const ButterflyHistory* history);
+    
+    // Quiescence: tactical moves only (captures, en passant, queen
+    // promotions), best first
+    explicit MovePicker(const Board& board);
+    
+    // Next move to search, or a null move (data == 0) once every stage is done
+    Move next_move();
+    
+private:
+    enum Stage {
+        HASH_MOVE,
+        GENERATE_CAPTURES,
+        GOOD_CAPTURES,
+        REFUTATIONS,
+        GENERATE_QUIETS,
+        QUIETS,
+        BAD_CAPTURES,
+        QSEARCH_GENERATE,
+        QSEARCH_CAPTURES,
+        DONE
+    };
+    
+    const Board& board;
+    const ButterflyHistory* history;
+    Move hash_move;
+    Move refutations[3]; // two killers, then the counter-move
+    Stage stage;
+    
+    // Captures, then quiets appended after them. Losing captures are moved to
+    // the front of the list, whose slots have already been picked.
+    MoveList moves;
+    int current;
+    int bad_captures_end;
+    int refutation_index;
+    
+    void score_captures();
+    void score_quiets(int begin);
+    
+    // Swap the best-scored move in [current, size) to current and return it
+    const ScoredMove& pick_best();
+    
+    // Hash moves and refutations are tried before their stage is generated
+    bool is_special(const Move& move) const;
+};
@@ -0,0 +1,197 @@
+#include "perft.h"
+#include "lockless.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Perft {
+
+uint64_t perft(Board& board, int depth) {
+    if (depth <= 0) return 1;
+    
+    // Bulk counting: the moves at the last ply are leaves, so only count them
+    if (depth == 1) return board.count_legal_moves();
+    
+    MoveList moves;
+    board.generate_legal_moves(moves);
+    
+    uint64_t nodes = 0;
+    for (const Move& move : moves) {
+        MoveInfo info;
+        board.make_move(move, info);
+        nodes += perft(board, depth - 1);
+        board.undo_move(info);
+    }
+    return nodes;
+}
+
+// Subtree counts keyed by Zobrist key and depth, shared by all threads
+// without locks (a torn entry fails the key check instead of returning a
+// wrong count)
+class PerftHash {
+public:
+    explicit PerftHash(size_t mb) {
+        size_t count = 1;
+        while (count * 2 * sizeof(LocklessEntry) <= mb * 1024 * 1024) count *= 2;
+        entries.reset(new LocklessEntry[count]);
+        mask = count - 1;
+        for (size_t i = 0; i < count; i++) {
+            entries[i].clear();
+        }
+    }
+    
+    bool probe(uint64_t key, int depth, uint64_t& nodes) const {
+        uint64_t data = entries[key & mask].probe(key);
+        if (data == 0 || int(data & 0xFF) != depth) return false;
+        nodes = data >> 8;
+        return true;
+    }
+    
+    void store(uint64_t key, int depth, uint64_t nodes) {
+        entries[key & mask].store(key, (nodes << 8) | uint64_t(depth));
+    }
+    
+private:
+    std::unique_ptr<LocklessEntry[]> entries;
+    size_t mask;
+};
+
+static uint64_t hashed_perft(Board& board, int depth, PerftHash* hash) {
+    // Shallow subtrees are cheaper to count than to look up
+    if (!hash || depth < 2) return perft(board, depth);
+    
+    uint64_t nodes;
+    if (hash->probe(board.get_key(), depth, nodes)) return nodes;
+    
+    MoveList moves;
+    board.generate_legal_moves(moves);
+    
+    nodes = 0;
+    for (const Move& move : moves) {
+        MoveInfo info;
+        board.make_move(move, info);
+        nodes += hashed_perft(board, depth - 1, hash);
+        board.undo_move(info);
+    }
+    
+    hash->store(board.get_key(), depth, nodes);
+    return nodes;
+}
+
+// One subtree below the first plies, counted by whichever thread takes it
+struct PerftTask {
+    Board board;
+    int depth;
+    int root_index;
+    uint64_t nodes;
+};
+
+// Count every root move's subtree, writing the counts to root_counts in
+// move generation order
+static void split_perft(const Board& board, int depth, int threads, size_t hash_mb,
+                        MoveList& root_moves, std::vector<uint64_t>& root_counts) {
+    board.generate_legal_moves(root_moves);
+    root_counts.assign(root_moves.size(), 0);
+    if (depth <= 0) return;
+    
+    // Split two plies deep when there is enough work below them, so there are
+    // hundreds of tasks and threads finishing early can keep taking more
+    std::vector<PerftTask> tasks;
+    for (int i = 0; i < root_moves.size(); i++) {
+        Board child = board;
+        child.make_move(root_moves[i]);
+        
+        if (depth >= 3) {
+            MoveList replies;
+            child.generate_legal_moves(replies);
+            for (const Move& reply : replies) {
+                Board grandchild = child;
+                grandchild.make_move(reply);
+                tasks.push_back({grandchild, depth - 2, i, 0});
+            }
+        } else {
+            tasks.push_back({child, depth - 1, i, 0});
+        }
+    }
+    
+    std::unique_ptr<PerftHash> hash;
+    if (hash_mb > 0) hash.reset(new PerftHash(hash_mb));
+    
+    std::atomic<size_t> next_task(0);
+    auto worker = [&]() {
+        for (size_t i = next_task++; i < tasks.size(); i = next_task++) {
+            tasks[i].nodes = hashed_perft(tasks[i].board, tasks[i].depth, hash.get());
+        }
+    };
+    
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threads; i++) {
+        helpers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    
+    for (const PerftTask& task : tasks) {
+        root_counts[task.root_index] += task.nodes;
+    }
+}
+
+uint64_t parallel_perft(const Board& board, int depth, int threads, size_t hash_mb) {
+    if (depth <= 1) {
+        Board copy = board;
+        return perft(copy, depth);
+    }
+    
+    MoveList root_moves;
+    std::vector<uint64_t> root_counts;
+    split_perft(board, depth, threads, hash_mb, root_moves, root_counts);
+    
+    uint64_t nodes = 0;
+    for (uint64_t count : root_counts) {
+        nodes += count;
+    }
+    return nodes;
+}
+
+static void print_summary(uint64_t nodes, int threads, size_t hash_mb, std::chrono::steady_clock::time_point start_time) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "Nodes: " << nodes << "\n";
+    std::cout << "Time: " << uint64_t(seconds * 1000) << "ms\n";
+    std::cout << "NPS: " << (seconds > 0 ? uint64_t(nodes / seconds) : 0) << "\n";
+    if (threads > 1 || hash_mb > 0) {
+        std::cout << "Threads: " << threads << ", hash: " << hash_mb << "MB\n";
+    }
+}
+
+uint64_t run(Board& board, int depth, int threads, size_t hash_mb) {
+    auto start_time = std::chrono::steady_clock::now();
+    uint64_t nodes = (threads > 1 || hash_mb > 0) ? parallel_perft(board, depth, threads, hash_mb)
+                                                  : perft(board, depth);
+    print_summary(nodes, threads, hash_mb, start_time);
+    return nodes;
+}
+
+uint64_t divide(Board& board, int depth, int threads, size_t hash_mb) {
+    auto start_time = std::chrono::steady_clock::now();
+    
+    MoveList moves;
+    std::vector<uint64_t> counts;
+    split_perft(board, depth, threads, hash_mb, moves, counts);
+    
+    uint64_t nodes = 0;
+    for (int i = 0; i < moves.size(); i++) {
+        std::cout << moves[i].to_string() << ": " << counts[i] << "\n";
+        nodes += counts[i];
+    }
+    
+    std::cout << "\n";
+    print_summary(nodes, threads, hash_mb, start_time);
+    return nodes;
+}
+
+} // namespace Perft
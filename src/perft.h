@@ -0,0 +1,19 @@
+#pragma once
+#include "board.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Perft {
+    // Count the leaf nodes of the legal move tree to the given depth
+    uint64_t perft(Board& board, int depth);
+    
+    // Perft with the first plies split into tasks that worker threads take
+    // from a shared queue. hash_mb > 0 adds a perft hash shared by all threads.
+    uint64_t parallel_perft(const Board& board, int depth, int threads, size_t hash_mb);
+    
+    // Print the node count and speed of a perft run
+    uint64_t run(Board& board, int depth, int threads = 1, size_t hash_mb = 0);
+    
+    // Like run, but also print the subtree count under each root move
+    uint64_t divide(Board& board, int depth, int threads = 1, size_t hash_mb = 0);
+}
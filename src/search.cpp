@@ -1,121 +1,439 @@
 #include "search.h"
 #include "movegen.h"
+#include "movepick.h"
+#include "tt.h"
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 namespace Search {
 
-// Global variables for search
-static std::chrono::steady_clock::time_point search_start_time;
-static int search_max_time_ms;
-static bool search_time_up = false;
+// Half-width of the first aspiration window, in centipawns
+static constexpr int ASPIRATION_WINDOW = 50;
 
-SearchResult search(const Board& board, const SearchParams& params) {
-    SearchResult result;
-    search_start_time = std::chrono::steady_clock::now();
-    search_max_time_ms = params.max_time_ms;
-    search_time_up = false;
+// Null-move pruning applies from this depth, and null-move cutoffs are
+// verified by a reduced search without null moves from VERIFICATION_DEPTH
+static constexpr int NULL_MOVE_DEPTH = 3;
+static constexpr int VERIFICATION_DEPTH = 8;
+
+// Passing is only safe to assume worse than the best move when the side to
+// move has something other than pawns to move. With pawns only, or a single
+// minor piece, zugzwang is common and a null move would prove nothing.
+static bool null_move_allowed(const Board& board) {
+    Color us = board.get_side_to_move();
+    Bitboard minors = board.get_pieces(us, KNIGHT) | board.get_pieces(us, BISHOP);
+    Bitboard majors = board.get_pieces(us, ROOK) | board.get_pieces(us, QUEEN);
+    return majors || BitboardUtils::popcount(minors) >= 2;
+}
+
+// Late move reductions apply from this depth. Below LATE_MOVE_PRUNING_DEPTH,
+// quiet moves past LATE_MOVE_COUNT[depth] are not searched at all.
+static constexpr int LMR_DEPTH = 3;
+static constexpr int LATE_MOVE_PRUNING_DEPTH = 4;
+static constexpr int LATE_MOVE_COUNT[LATE_MOVE_PRUNING_DEPTH] = {0, 5, 8, 13};
+
+// Late move reduction in plies by [depth][move number]: grows with the log
+// of both, since a move far down a well-ordered list at high depth is
+// unlikely to be best
+static const std::array<std::array<int, 64>, 64> REDUCTIONS = [] {
+    std::array<std::array<int, 64>, 64> table{};
+    for (int depth = 1; depth < 64; depth++) {
+        for (int moves = 1; moves < 64; moves++) {
+            table[depth][moves] = int(0.75 + std::log(depth) * std::log(moves) / 2.25);
+        }
+    }
+    return table;
+}();
+
+// History scores stay within +-HISTORY_MAX: each update moves an entry
+// toward the bound by a fraction of the distance left (history gravity), so
+// old results fade instead of saturating
+static constexpr int HISTORY_MAX = 16384;
+
+static void update_history(int& entry, int bonus) {
+    entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+}
+
+// A quiet move caused a beta cutoff: make it a killer at this ply and the
+// counter-move to the opponent's previous move, and raise its history while
+// lowering that of the quiet moves searched before it
+static void update_quiet_stats(ThreadData& td, const Board& board, int ply, int depth, Move move,
+                               const Move* quiets_tried, int quiet_count) {
+    StackEntry& entry = td.stack[ply];
+    if (entry.killers[0] != move) {
+        entry.killers[1] = entry.killers[0];
+        entry.killers[0] = move;
+    }
     
-    std::vector<Move> moves = board.generate_legal_moves();
-    if (moves.empty()) {
-        return result; // No legal moves
+    if (ply > 0 && td.stack[ply - 1].move.data != 0) {
+        Move previous = td.stack[ply - 1].move;
+        td.counter_moves[previous.from()][previous.to()] = move;
     }
     
-    // Iterative deepening
-    for (int depth = 1; depth <= params.max_depth && !search_time_up; depth++) {
-        Move best_move_at_depth = moves[0];
-        int best_score = -1000000;
-        int alpha = -1000000;
-        int beta = 1000000;
+    Color us = board.get_side_to_move();
+    int bonus = std::min(32 * depth * depth, HISTORY_MAX / 4);
+    update_history(td.history[us][move.from()][move.to()], bonus);
+    for (int i = 0; i < quiet_count; i++) {
+        update_history(td.history[us][quiets_tried[i].from()][quiets_tried[i].to()], -bonus);
+    }
+}
+
+// Mate scores are stored relative to the node rather than the root, so an
+// entry reached at a different ply still gives the right distance to mate
+static int score_to_tt(int score, int ply) {
+    if (score >= MATE_IN_MAX_PLY) return score + ply;
+    if (score <= -MATE_IN_MAX_PLY) return score - ply;
+    return score;
+}
+
+static int score_from_tt(int score, int ply) {
+    if (score >= MATE_IN_MAX_PLY) return score - ply;
+    if (score <= -MATE_IN_MAX_PLY) return score + ply;
+    return score;
+}
+
+// The main thread reads the clock every 1024 nodes and raises the shared
+// stop flag; every thread polls the flag
+static bool should_stop(ThreadData& td) {
+    if (td.id == 0 && (td.nodes & 1023) == 0 &&
+        is_time_up(td.shared->start_time, td.shared->max_time_ms)) {
+        td.shared->stop.store(true, std::memory_order_relaxed);
+    }
+    return td.shared->stop.load(std::memory_order_relaxed);
+}
+
+// Principal variation search over the root moves at one depth. The first
+// move gets the full window and the rest a null window, re-searched with the
+// full window only if they beat alpha. Returns the best score (which is only
+// a bound if it falls outside the window) and sets best_move, leaving it
+// unchanged if every move fails low.
+static int search_root(ThreadData& td, Board& board, const MoveList& moves, int depth,
+                       int alpha, int beta, Move& best_move) {
+    int best_score = -INFINITE_SCORE;
+    for (int i = 0; i < moves.size(); i++) {
+        const Move& move = moves[i];
+        td.stack[0].move = move;
+        MoveInfo info;
+        board.make_move(move, info);
+        int score;
+        if (i == 0) {
+            score = -minimax(td, board, depth - 1, 1, -beta, -alpha);
+        } else {
+            score = -minimax(td, board, depth - 1, 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta) {
+                score = -minimax(td, board, depth - 1, 1, -beta, -alpha);
+            }
+        }
+        board.undo_move(info);
+        if (td.shared->stop.load(std::memory_order_relaxed)) break;
         
-        // Search each move at current depth
-        for (const Move& move : moves) {
-            if (search_time_up) break;
-            
-            Board temp_board = board;
-            temp_board.make_move(move);
-            
-            int score = -minimax(temp_board, depth - 1, -beta, -alpha, result.nodes_searched);
+        if (score > best_score) {
+            best_score = score;
+            if (score > alpha) best_move = move;
+        }
+        
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) break;
+    }
+    return best_score;
+}
+
+// Iterative deepening over the root moves, as run by each thread. Helpers
+// start on different depths and move orders than the main thread so they
+// do not all search the same tree in lockstep, and fill the table with
+// results the main thread then finds.
+static void iterative_deepening(ThreadData& td, const Board& root, MoveList moves, int max_depth,
+                               SearchResult& result) {
+    Board board = root;
+    if (td.id > 0 && moves.size() > 2) {
+        std::rotate(moves.begin() + 1, moves.begin() + 1 + td.id % (moves.size() - 1), moves.end());
+    }
+    
+    int previous_score = 0;
+    uint64_t previous_iteration_nodes = 0;
+    for (int depth = 1 + (td.id & 1); depth <= max_depth; depth++) {
+        uint64_t nodes_before = td.nodes;
+        // Aspiration window: from depth 4, expect a score close to the last
+        // iteration's and widen the failing side on each fail high or low.
+        // Mate scores jump between iterations, so they get a full window.
+        int delta = ASPIRATION_WINDOW;
+        int alpha = -INFINITE_SCORE;
+        int beta = INFINITE_SCORE;
+        if (depth >= 4 && std::abs(previous_score) < MATE_IN_MAX_PLY) {
+            alpha = previous_score - delta;
+            beta = previous_score + delta;
+        }
+        
+        Move best_move_at_depth = moves[0];
+        int best_score;
+        while (true) {
+            best_score = search_root(td, board, moves, depth, alpha, beta, best_move_at_depth);
+            if (td.shared->stop.load(std::memory_order_relaxed)) break;
             
-            if (score > best_score) {
-                best_score = score;
-                best_move_at_depth = move;
+            if (best_score <= alpha) {
+                alpha = std::max(best_score - delta, -INFINITE_SCORE);
+            } else if (best_score >= beta) {
+                beta = std::min(best_score + delta, INFINITE_SCORE);
+            } else {
+                break;
             }
+            delta *= 2;
             
-            alpha = std::max(alpha, score);
-            if (alpha >= beta) break;
+            // Search the move that failed high first in the re-search
+            ScoredMove* best = std::find(moves.begin(), moves.end(), best_move_at_depth);
+            std::rotate(moves.begin(), best, best + 1);
         }
         
-        // Update result if we completed this depth
-        if (!search_time_up) {
-            result.best_move = best_move_at_depth;
-            result.score = best_score;
-            result.depth = depth;
-        }
+        // An iteration cut short is discarded
+        if (td.shared->stop.load(std::memory_order_relaxed)) break;
+        
+        // Keep the result, and search its best move first in the next iteration
+        result.best_move = best_move_at_depth;
+        result.score = best_score;
+        result.depth = depth;
+        previous_score = best_score;
+        uint64_t iteration_nodes = td.nodes - nodes_before;
+        if (previous_iteration_nodes) result.ebf = double(iteration_nodes) / previous_iteration_nodes;
+        previous_iteration_nodes = iteration_nodes;
+        ScoredMove* best = std::find(moves.begin(), moves.end(), best_move_at_depth);
+        std::rotate(moves.begin(), best, best + 1);
+        TT.store(board.get_key(), best_move_at_depth, score_to_tt(best_score, 0), depth, BOUND_EXACT);
+    }
+}
+
+SearchResult search(const Board& board, const SearchParams& params) {
+    SharedState shared;
+    shared.start_time = std::chrono::steady_clock::now();
+    shared.max_time_ms = params.max_time_ms;
+    shared.stop.store(false);
+    TT.new_search();
+    
+    MoveList moves;
+    order_moves(moves, board);
+    if (moves.empty()) {
+        return SearchResult(); // No legal moves
     }
     
+    int threads = std::max(1, params.threads);
+    // Value-initialized, so every thread starts with empty killer, history
+    // and counter-move tables
+    std::vector<ThreadData> thread_data(threads);
+    std::vector<SearchResult> results(threads);
+    for (int i = 0; i < threads; i++) {
+        thread_data[i].shared = &shared;
+        thread_data[i].id = i;
+        thread_data[i].nodes = 0;
+        thread_data[i].verifying_null_move = false;
+    }
+    
+    // Helpers go as deep as they can until the main thread stops them
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threads; i++) {
+        helpers.emplace_back([&, i] {
+            iterative_deepening(thread_data[i], board, moves, MAX_PLY - 1, results[i]);
+        });
+    }
+    iterative_deepening(thread_data[0], board, moves, params.max_depth, results[0]);
+    shared.stop.store(true);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    
+    // The main thread's result is the answer; the helpers only contributed
+    // through the table
+    SearchResult result = results[0];
+    for (const ThreadData& td : thread_data) {
+        result.nodes_searched += td.nodes;
+    }
+    result.hashfull = TT.hashfull();
     result.time_taken = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now() - search_start_time);
+        std::chrono::steady_clock::now() - shared.start_time);
     
     return result;
 }
 
-int minimax(Board& board, int depth, int alpha, int beta,  int& nodes) {
-    nodes++;
+int minimax(ThreadData& td, Board& board, int depth, int ply, int alpha, int beta) {
+    td.nodes++;
+    if (should_stop(td)) return 0;
     
-    // Check for time up
-    if (is_time_up(search_start_time, search_max_time_ms)) {
-        search_time_up = true;
-        return 0;
-    }
+    // A side in check at the horizon gets one more ply, so a mate delivered
+    // by the last move is scored as a mate rather than by quiescence
+    if (depth == 0 && board.is_check()) depth = 1;
     
     // Terminal node evaluation
-    if (depth == 0) {
-        if (search_time_up) return 0;
-        return quiescence(board, alpha, beta, nodes);
+    if (depth == 0 || ply >= MAX_PLY) {
+        return quiescence(td, board, alpha, beta);
     }
     
     // Check for game over
     if (board.is_game_over()) {
         if (board.is_checkmate()) {
-            return -100000 + depth;
+            return -MATE_SCORE + ply;
         }
         if (board.is_stalemate() || board.is_draw()) {
             return 0;
         }
     }
     
-    std::vector<Move> moves = board.generate_legal_moves();
-    order_moves(moves, board);
+    // Nodes searched with an open window can still change the principal
+    // variation; everything else is searched with a null window
+    bool pv_node = beta - alpha > 1;
+    
+    // A stored result at least as deep as this search answers it outright
+    // when its bound is on the right side of the window. PV nodes search on
+    // so the principal variation is not cut short by an old entry.
+    TTData tt_data;
+    bool tt_hit = TT.probe(board.get_key(), tt_data);
+    Move tt_move = tt_hit ? tt_data.move : Move();
+    if (!pv_node && tt_hit && tt_data.depth >= depth) {
+        int tt_score = score_from_tt(tt_data.score, ply);
+        if (tt_data.bound == BOUND_EXACT ||
+            (tt_data.bound == BOUND_LOWER && tt_score >= beta) ||
+            (tt_data.bound == BOUND_UPPER && tt_score <= alpha)) {
+            return tt_score;
+        }
+    }
+    
+    // Null-move pruning: if the side to move could pass and a reduced
+    // search still fails high, a real move would too. Not in check (passing
+    // would be illegal), not twice in a row, and not where zugzwang is
+    // likely. The reduction grows with depth and with how far the static
+    // evaluation is above beta, but leaves at least one ply of full-width
+    // search so the null-move search does not drop straight into quiescence
+    // (which cannot see a mate threat).
+    if (!pv_node && depth >= NULL_MOVE_DEPTH && !td.verifying_null_move &&
+        (ply == 0 || td.stack[ply - 1].move.data != 0) &&
+        !board.is_check() && null_move_allowed(board)) {
+        int static_eval = Eval::evaluate(board);
+        if (static_eval >= beta) {
+            int reduction = 3 + depth / 4 + std::min((static_eval - beta) / 200, 2);
+            reduction = std::min(reduction, depth - 2);
+            int null_depth = depth - 1 - reduction;
+            
+            td.stack[ply].move = Move();
+            MoveInfo info;
+            board.make_null_move(info);
+            int null_score = -minimax(td, board, null_depth, ply + 1, -beta, -beta + 1);
+            board.undo_null_move(info);
+            if (td.shared->stop.load(std::memory_order_relaxed)) return 0;
+            
+            if (null_score >= beta) {
+                // A mate found after passing is not a real mate
+                if (null_score >= MATE_IN_MAX_PLY) null_score = beta;
+                if (depth < VERIFICATION_DEPTH) return null_score;
+                
+                // At high depth a wrong cutoff prunes a large tree, so confirm
+                // it with a reduced search of this node without null moves
+                td.verifying_null_move = true;
+                int verified = minimax(td, board, std::max(depth - reduction, 1), ply, beta - 1, beta);
+                td.verifying_null_move = false;
+                if (verified >= beta) return null_score;
+            }
+        }
+    }
+    
+    // Moves are generated stage by stage, so a cutoff on the hash move or
+    // an early capture skips generating (and ordering) the quiet moves
+    Move counter_move = Move();
+    if (ply > 0 && td.stack[ply - 1].move.data != 0) {
+        counter_move = td.counter_moves[td.stack[ply - 1].move.from()][td.stack[ply - 1].move.to()];
+    }
+    MovePicker picker(board, tt_move, td.stack[ply].killers, counter_move, &td.history);
+    
+    Color us = board.get_side_to_move();
+    bool in_check = board.is_check();
+    int original_alpha = alpha;
+    int best_score = -INFINITE_SCORE;
+    Move best_move = Move();
+    int move_count = 0;
     
-    int best_score  = -1000000;
-    for (const Move& move : moves) {
-        if (search_time_up) break;
+    // Quiet moves searched so far, whose history a later cutoff lowers
+    Move quiets_tried[64];
+    int quiet_count = 0;
+    for (Move move = picker.next_move(); move.data != 0; move = picker.next_move()) {
+        bool quiet = !move.is_capture() && !move.is_promotion();
+        MoveInfo info;
+        board.make_move(move, info);
+        bool gives_check = board.is_check();
+        
+        // Late move pruning: at low depth, once enough moves have been tried
+        // without a cutoff, the remaining quiet moves that do not give check
+        // are unlikely to give one
+        if (!pv_node && !in_check && quiet && !gives_check && depth < LATE_MOVE_PRUNING_DEPTH &&
+            move_count >= LATE_MOVE_COUNT[depth] && best_score > -MATE_IN_MAX_PLY) {
+            board.undo_move(info);
+            continue;
+        }
         
-        board.make_move(move);
-        int eval = -minimax(board, depth - 1, -beta, -alpha, nodes);
-        board.undo_move();
+        move_count++;
+        td.stack[ply].move = move;
         
-        best_score = std::max(best_score, eval);
+        // Principal variation search: the first move is expected to be best,
+        // so later ones only need proving worse with a null window, and are
+        // searched again with the full window if they turn out better
+        int eval;
+        if (move_count == 1) {
+            eval = -minimax(td, board, depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            // Late quiet moves are first searched to a reduced depth, less so
+            // on the principal variation, for checks, killers and the
+            // counter-move and for moves with a good history, and searched
+            // again at full depth if they beat alpha anyway
+            int reduction = 0;
+            if (depth >= LMR_DEPTH && quiet && !in_check) {
+                reduction = REDUCTIONS[std::min(depth, 63)][std::min(move_count, 63)];
+                if (pv_node) reduction--;
+                if (gives_check) reduction--;
+                if (move == td.stack[ply].killers[0] || move == td.stack[ply].killers[1] || move == counter_move) {
+                    reduction--;
+                }
+                reduction -= td.history[us][move.from()][move.to()] / (HISTORY_MAX / 2);
+                reduction = std::max(0, std::min(reduction, depth - 2));
+            }
+            
+            eval = -minimax(td, board, depth - 1 - reduction, ply + 1, -alpha - 1, -alpha);
+            if (eval > alpha && reduction > 0) {
+                eval = -minimax(td, board, depth - 1, ply + 1, -alpha - 1, -alpha);
+            }
+            if (eval > alpha && eval < beta) {
+                eval = -minimax(td, board, depth - 1, ply + 1, -beta, -alpha);
+            }
+        }
+        board.undo_move(info);
+        if (td.shared->stop.load(std::memory_order_relaxed)) return 0;
+        
+        if (eval > best_score) {
+            best_score = eval;
+            best_move = move;
+        }
         alpha = std::max(alpha, eval);
-        if (beta <= alpha) break; // Beta cutoff
+        if (beta <= alpha) {
+            // Beta cutoff
+            if (quiet) update_quiet_stats(td, board, ply, depth, move, quiets_tried, quiet_count);
+            break;
+        }
+        if (quiet && quiet_count < 64) quiets_tried[quiet_count++] = move;
     }
+    
+    // When every move failed low none of them is known to be best
+    Bound bound = best_score >= beta ? BOUND_LOWER :
+                  best_score > original_alpha ? BOUND_EXACT : BOUND_UPPER;
+    TT.store(board.get_key(), bound == BOUND_UPPER ? Move() : best_move,
+             score_to_tt(best_score, ply), depth, bound);
     return best_score;
 }
 
-int quiescence(Board& board, int alpha, int beta, int& nodes) {
-    nodes++;
-    
-    // Check for time up
-    if (is_time_up(search_start_time, search_max_time_ms)) {
-        search_time_up = true;
-        return 0;
-    }
+int quiescence(ThreadData& td, Board& board, int alpha, int beta) {
+    td.nodes++;
+    if (should_stop(td)) return 0;
     
     // Static evaluation
     int stand_pat = Eval::evaluate(board);
     
-    if (stand_pat >= beta) return beta;
+    if (stand_pat >= beta) return stand_pat;
 
     // Delta pruning - if even capturing the most valuable piece 
     // can't raise alpha, skip quiescence search
@@ -126,17 +444,20 @@ int quiescence(Board& board, int alpha, int beta, int& nodes) {
 
     if (stand_pat > alpha) alpha = stand_pat;
     
-    // Generate only capture moves
-    std::vector<Move> captures = board.generate_captures();
-    order_moves(captures, board);
+    // Only captures and queen promotions, best first
+    MovePicker picker(board);
     
     int best_score = stand_pat;
-    for (const Move& move : captures) {
-        if (search_time_up) break;
+    for (Move move = picker.next_move(); move.data != 0; move = picker.next_move()) {
+        // Captures that lose material in the exchange cannot raise a score
+        // the side to move could already have by standing pat
+        if (Eval::see(board, move) < 0) continue;
         
-        board.make_move(move);
-        int eval = -quiescence(board, -beta, -alpha, nodes);
-        board.undo_move();
+        MoveInfo info;
+        board.make_move(move, info);
+        int eval = -quiescence(td, board, -beta, -alpha);
+        board.undo_move(info);
+        if (td.shared->stop.load(std::memory_order_relaxed)) return 0;
         
         best_score = std::max(best_score, eval);
         alpha = std::max(alpha, eval);
@@ -145,49 +466,13 @@ int quiescence(Board& board, int alpha, int beta, int& nodes) {
     return best_score;
 }
 
-void order_moves(std::vector<Move>& moves, const Board& board) {
-    std::vector<std::pair<int, Move>> scored_moves;
-    
-    for (const Move& move : moves) {
-        int score = 0;
-        
-        // Captures get high priority
-        if (move.is_capture()) {
-            Piece captured_piece = board.get_piece(move.to());
-            Piece moving_piece = board.get_piece(move.from());
-            score += Eval::get_piece_value(captured_piece) * 10 - Eval::get_piece_value(moving_piece);
-        }
-        
-        // Promotions get high priority
-        if (move.is_promotion()) {
-            score += Eval::get_piece_value(move.promotion()) * 8;
-        }
-        
-        // Castling gets medium priority
-        if (move.is_castle()) {
-            score += 50;
-        }
-        
-        // Pawn pushes to center get some priority
-        if (board.get_piece(move.from()) == PAWN) {
-            int to_rank = BitboardUtils::rank_of(move.to());
-            int to_file = BitboardUtils::file_of(move.to());
-            if (to_file >= 2 && to_file <= 5 && to_rank >= 3 && to_rank <= 4) {
-                score += 10;
-            }
-        }
-        
-        scored_moves.emplace_back(score, move);
-    }
-    
-    // Sort by score (highest first)
-    std::sort(scored_moves.begin(), scored_moves.end(), 
-              [](const auto& a, const auto& b) { return a.first > b.first; });
-    
-    // Extract moves in sorted order
+void order_moves(MoveList& moves, const Board& board) {
+    // Drain a picker so the root ranks moves by the same rules as every
+    // other node. Its moves are legal and come out best first.
+    MovePicker picker(board, Move(), nullptr, Move(), nullptr);
     moves.clear();
-    for (const auto& scored_move : scored_moves) {
-        moves.push_back(scored_move.second);
+    for (Move move = picker.next_move(); move.data != 0; move = picker.next_move()) {
+        moves.push_back(move);
     }
 }
 
@@ -1,19 +1,31 @@
 #pragma once
 #include "board.h"
 #include "eval.h"
-#include <vector>
+#include "movepick.h"
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 
 namespace Search {
+    // Score bounds. Mate scores are MATE_SCORE minus the distance to mate in
+    // plies from the root, so anything beyond MATE_IN_MAX_PLY is a mate.
+    constexpr int INFINITE_SCORE = 1000000;
+    constexpr int MATE_SCORE = 100000;
+    constexpr int MAX_PLY = 128;
+    constexpr int MATE_IN_MAX_PLY = MATE_SCORE - MAX_PLY;
+    
     // Search result structure
     struct SearchResult {
         Move best_move;
         int score;
         int depth;
-        int nodes_searched;
+        uint64_t nodes_searched; // summed over all threads
+        int hashfull; // transposition table fill, permille
+        double ebf;   // effective branching factor: main thread nodes of the last
+                      // completed iteration over those of the one before
         std::chrono::milliseconds time_taken;
         
-        SearchResult() : best_move(), score(0), depth(0), nodes_searched(0), time_taken(0) {}
+        SearchResult() : best_move(), score(0), depth(0), nodes_searched(0), hashfull(0), ebf(0), time_taken(0) {}
     };
     
     // Search parameters
@@ -21,21 +33,53 @@ namespace Search {
         int max_depth;
         int max_time_ms;
         bool use_quiescence;
+        int threads;
         
-        SearchParams() : max_depth(4), max_time_ms(5000), use_quiescence(true) {}
+        SearchParams() : max_depth(4), max_time_ms(5000), use_quiescence(true), threads(1) {}
+    };
+    
+    // State shared by every thread of one search. Only the main thread reads
+    // the clock; it sets stop when time is up or its last iteration is done.
+    struct SharedState {
+        std::chrono::steady_clock::time_point start_time;
+        int max_time_ms;
+        std::atomic<bool> stop;
+    };
+    
+    // What a thread knows about each ply of the line it is searching
+    struct StackEntry {
+        Move move;       // the move being searched from this ply; null for a null move
+        Move killers[2]; // the last two quiet moves that caused a cutoff at this ply
+    };
+    
+    // One search thread's own state. The move ordering tables (killers,
+    // history, counter-moves) live for the whole search, so each iteration of
+    // iterative deepening starts from what the previous ones learned.
+    struct ThreadData {
+        SharedState* shared;
+        int id; // 0 for the main thread
+        uint64_t nodes;
+        bool verifying_null_move; // no null moves inside a verification search
+        StackEntry stack[MAX_PLY];
+        ButterflyHistory history;
+        Move counter_moves[64][64]; // quiet refutation by [from][to] of the previous move
     };
     
-    // Main search function
+    // Main search function. With params.threads > 1 this is a Lazy SMP
+    // search: helper threads search the same root with perturbed depths and
+    // move order, and share what they find through the transposition table.
     SearchResult search(const Board& board, const SearchParams& params = SearchParams());
     
-    // Minimax with alpha-beta pruning
-    int minimax(Board& board, int depth, int alpha, int beta, int& nodes);
+    // Minimax with alpha-beta pruning; ply is the distance from the root
+    int minimax(ThreadData& td, Board& board, int depth, int ply, int alpha, int beta);
     
     // Quiescence search (capture-only search)
-    int quiescence(Board& board, int alpha, int beta, int& nodes);
+    int quiescence(ThreadData& td, Board& board, int alpha, int beta);
     
-    // Move ordering for better alpha-beta pruning
-    void order_moves(std::vector<Move>& moves, const Board& board);
+    // Fill moves with the legal moves in the order the move picker would try
+    // them with no hash move, refutations or history (the root's first
+    // iteration has none yet)
+    void order_moves(MoveList& moves, const Board& board);
     
     // Utility functions
     bool is_time_up(const std::chrono::steady_clock::time_point& start_time, int max_time_ms);
@@ -0,0 +1,111 @@
+#include "tt.h"
+
+TranspositionTable TT;
+
+TranspositionTable::TranspositionTable(size_t mb) : requested_mb(mb), mask(0), generation(0) {}
+
+size_t TranspositionTable::bucket_count(size_t mb) {
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= mb * 1024 * 1024) count *= 2;
+    return count;
+}
+
+void TranspositionTable::resize(size_t mb) {
+    size_t count = bucket_count(mb);
+    buckets.reset(new Bucket[count]);
+    requested_mb = mb;
+    mask = count - 1;
+    clear();
+}
+
+void TranspositionTable::new_search() {
+    if (!buckets) resize(requested_mb);
+    generation = (generation + 1) & GENERATION_MASK;
+}
+
+void TranspositionTable::clear() {
+    generation = 0;
+    if (!buckets) return;
+    for (size_t i = 0; i <= mask; i++) {
+        for (Entry& entry : buckets[i].entries) {
+            entry.clear();
+        }
+    }
+}
+
+uint64_t TranspositionTable::pack(Move move, int score, int depth, Bound bound, uint8_t generation) {
+    return uint64_t(move.data)
+         | (uint64_t(depth & 0xFF) << 16)
+         | (uint64_t(bound) << 24)
+         | (uint64_t(generation) << 26)
+         | (uint64_t(uint32_t(score)) << 32);
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData& data) const {
+    const Bucket& bucket = buckets[key & mask];
+    for (const Entry& entry : bucket.entries) {
+        uint64_t entry_data = entry.probe(key);
+        if (entry_data != 0) {
+            data.move.data = uint16_t(entry_data);
+            data.score = int32_t(uint32_t(entry_data >> 32));
+            data.depth = depth_of(entry_data);
+            data.bound = bound_of(entry_data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, Bound bound) {
+    Bucket& bucket = buckets[key & mask];
+    
+    // Overwrite this position's own entry if it has one, unless it holds a
+    // clearly deeper result from this search that the new one is only a
+    // bound on (a reduced or verification re-search, or a helper thread at
+    // a lower depth). Otherwise replace the least valuable entry: empty ones
+    // first, then the shallowest, counting each search of age as 8 plies of
+    // depth lost.
+    Entry* replace = &bucket.entries[0];
+    int replace_value = 1 << 30;
+    for (Entry& entry : bucket.entries) {
+        uint64_t entry_data = entry.probe(key);
+        if (entry_data != 0) {
+            if (bound != BOUND_EXACT && depth < depth_of(entry_data) - REPLACE_DEPTH_MARGIN &&
+                generation_of(entry_data) == generation) {
+                return;
+            }
+            
+            // Keep the old best move when this search did not find one
+            if (move.data == 0) move.data = uint16_t(entry_data);
+            replace = &entry;
+            break;
+        }
+        
+        entry_data = entry.peek();
+        int value = -1000;
+        if (entry_data != 0) {
+            int age = (generation - generation_of(entry_data)) & GENERATION_MASK;
+            value = depth_of(entry_data) - 8 * age;
+        }
+        if (value < replace_value) {
+            replace = &entry;
+            replace_value = value;
+        }
+    }
+    
+    replace->store(key, pack(move, score, depth, bound, generation));
+}
+
+int TranspositionTable::hashfull() const {
+    // The first 250 buckets (1000 entries) are a fair sample, since keys are
+    // spread evenly over the table
+    size_t sample = (mask + 1 < 250) ? mask + 1 : 250;
+    int used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        for (const Entry& entry : buckets[i].entries) {
+            uint64_t data = entry.peek();
+            if (data != 0 && generation_of(data) == generation) used++;
+        }
+    }
+    return int(used * 1000 / (sample * BUCKET_SIZE));
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "board.h"
+#include "lockless.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// How a stored score relates to the true score of the position
+enum Bound : uint8_t {
+    BOUND_NONE = 0,
+    BOUND_UPPER = 1, // the search failed low: true score <= score
+    BOUND_LOWER = 2, // the search failed high: true score >= score
+    BOUND_EXACT = 3
+};
+
+// One probe result, unpacked
+struct TTData {
+    Move move;
+    int score;
+    int depth;
+    Bound bound;
+};
+
+// Transposition table: search results keyed by Zobrist key, so positions
+// reached by different move orders or in earlier iterations are not
+// searched again. Entries are 16 bytes, four to a 64-byte bucket, so a
+// probe touches a single cache line.
+//
+// All search threads share the table without locks (see LocklessEntry).
+class TranspositionTable {
+public:
+    static constexpr size_t DEFAULT_MB = 16;
+    
+    // Nothing is allocated until the first search (or resize), so processes
+    // that never search do not pay for zeroing the table at startup
+    explicit TranspositionTable(size_t mb = DEFAULT_MB);
+    
+    // Reallocate to the largest power-of-two bucket count that fits in mb
+    // megabytes (at least one bucket), which also clears the table
+    void resize(size_t mb);
+    void clear();
+    size_t size_mb() const { return bucket_count(requested_mb) * sizeof(Bucket) / (1024 * 1024); }
+    
+    // Start a new search, allocating the table on first use: entries from
+    // earlier searches become the first candidates for replacement
+    void new_search();
+    
+    bool probe(uint64_t key, TTData& data) const;
+    void store(uint64_t key, Move move, int score, int depth, Bound bound);
+    
+    // Permille of a sample of entries written during the current search
+    int hashfull() const;
+    
+private:
+    // Entry data packs bits 0-15 move, 16-23 depth, 24-25 bound, 26-31
+    // generation and 32-63 score
+    using Entry = LocklessEntry;
+    
+    static constexpr int BUCKET_SIZE = 4;
+    struct alignas(64) Bucket {
+        Entry entries[BUCKET_SIZE];
+    };
+    static_assert(sizeof(Bucket) == 64, "a bucket must fill one cache line");
+    
+    static constexpr uint8_t GENERATION_MASK = 0x3F;
+    
+    // A non-exact result for a position already stored from this search
+    // only replaces it if at most this many plies shallower
+    static constexpr int REPLACE_DEPTH_MARGIN = 2;
+    
+    static size_t bucket_count(size_t mb);
+    static uint64_t pack(Move move, int score, int depth, Bound bound, uint8_t generation);
+    static int depth_of(uint64_t data) { return int((data >> 16) & 0xFF); }
+    static Bound bound_of(uint64_t data) { return Bound((data >> 24) & 0x3); }
+    static uint8_t generation_of(uint64_t data) { return uint8_t((data >> 26) & GENERATION_MASK); }
+    
+    std::unique_ptr<Bucket[]> buckets; // null until first allocated
+    size_t requested_mb;
+    size_t mask;
+    uint8_t generation;
+};
+
+// The table shared by every search
+extern TranspositionTable TT;
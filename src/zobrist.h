@@ -0,0 +1,61 @@
+#pragma once
+#include "bitboard.h"
+#include <array>
+
+// Zobrist hashing keys, generated at compile time from a fixed seed so keys
+// (and anything keyed by them) are identical across runs and builds
+namespace Zobrist {
+    // xorshift64* step
+    constexpr uint64_t next_key(uint64_t& seed) {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 2685821657736338717ULL;
+    }
+    
+    struct Keys {
+        uint64_t pieces[2][6][64];   // [color][piece][square]
+        uint64_t castling[2][2];     // [color][queenside/kingside], as in GameState
+        uint64_t en_passant[8];      // [file of the en passant square]
+        uint64_t side;               // XORed in when black is to move
+    };
+    
+    inline constexpr Keys KEYS = [] {
+        Keys keys{};
+        uint64_t seed = 1070372;
+        for (int c = 0; c < 2; c++) {
+            for (int p = 0; p < 6; p++) {
+                for (int sq = 0; sq < 64; sq++) {
+                    keys.pieces[c][p][sq] = next_key(seed);
+                }
+            }
+        }
+        for (int c = 0; c < 2; c++) {
+            keys.castling[c][0] = next_key(seed);
+            keys.castling[c][1] = next_key(seed);
+        }
+        for (int f = 0; f < 8; f++) {
+            keys.en_passant[f] = next_key(seed);
+        }
+        keys.side = next_key(seed);
+        return keys;
+    }();
+    
+    constexpr uint64_t piece_key(Color color, Piece piece, Square sq) {
+        return KEYS.pieces[color][piece][sq];
+    }
+    
+    constexpr uint64_t castling_key(const bool castling_rights[2][2]) {
+        uint64_t key = 0;
+        for (int c = 0; c < 2; c++) {
+            for (int s = 0; s < 2; s++) {
+                if (castling_rights[c][s]) key ^= KEYS.castling[c][s];
+            }
+        }
+        return key;
+    }
+    
+    constexpr uint64_t en_passant_key(Square ep_square) {
+        return ep_square == SQUARE_NONE ? 0 : KEYS.en_passant[BitboardUtils::file_of(ep_square)];
+    }
+}
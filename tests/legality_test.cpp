@@ -0,0 +1,78 @@
+// Move validation: at every node of shallow trees, every 16-bit move
+// encoding must pass is_pseudo_legal and is_legal exactly when the legal
+// move generator produces it
+#include "board.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+static const char* FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+    "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1",
+    "4k2r/8/8/8/8/8/8/R3K3 w KQkq - 0 1", // castling rights without the rook
+};
+
+static const int DEPTH = 2;
+
+// Number of encodings the validator and the generator disagree on at this
+// node, printing the first few along with the moves leading to the node
+static int check_node(const Board& board, const std::string& line, int& reported) {
+    MoveList moves;
+    board.generate_legal_moves(moves);
+    bool generated[1 << 16] = {};
+    for (int i = 0; i < moves.size(); i++) generated[moves[i].data] = true;
+    
+    int mismatches = 0;
+    for (uint32_t data = 1; data < (1 << 16); data++) {
+        Move move;
+        move.data = uint16_t(data);
+        bool valid = board.is_pseudo_legal(move) && board.is_legal(move);
+        if (valid == generated[data]) continue;
+        
+        mismatches++;
+        if (reported++ < 10) {
+            std::cout << "FAIL  " << move.to_string() << " (0x" << std::hex << data << std::dec << ") "
+                      << (valid ? "accepted but not generated" : "generated but rejected")
+                      << "  after:" << line << "\n";
+        }
+    }
+    return mismatches;
+}
+
+static int check_tree(Board& board, int depth, const std::string& line, int& nodes, int& reported) {
+    nodes++;
+    int mismatches = check_node(board, line, reported);
+    if (depth == 0) return mismatches;
+    
+    MoveList moves;
+    board.generate_legal_moves(moves);
+    for (int i = 0; i < moves.size(); i++) {
+        MoveInfo info;
+        board.make_move(moves[i], info);
+        mismatches += check_tree(board, depth - 1, line + " " + moves[i].to_string(), nodes, reported);
+        board.undo_move(info);
+    }
+    return mismatches;
+}
+
+int main() {
+    int failures = 0;
+    int reported = 0;
+    for (const char* fen : FENS) {
+        Board board(fen);
+        int nodes = 0;
+        int mismatches = check_tree(board, DEPTH, "", nodes, reported);
+        if (mismatches) failures++;
+        std::cout << (mismatches ? "FAIL" : "PASS") << "  " << nodes << " nodes";
+        if (mismatches) std::cout << ", " << mismatches << " mismatches";
+        std::cout << "  " << fen << "\n";
+    }
+    
+    std::cout << failures << " of " << (sizeof(FENS) / sizeof(FENS[0])) << " positions failed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+// Perft regression suite: node counts for the standard test positions and
+// for positions targeting en passant, castling and promotion edge cases
+#include "board.h"
+#include "perft.h"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+struct PerftCase {
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+};
+
+static const PerftCase CASES[] = {
+    // Start position, Kiwipete and positions 3-6 from the Chess Programming Wiki
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+    
+    // En passant: discovered checks through the captured pawn
+    {"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467},
+    {"8/5bk1/8/2Pp4/8/1K6/8/8 w - d6 0 1", 6, 824064},
+    {"3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888},
+    
+    // Castling: rights, attacked paths and castling giving check
+    {"r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206},
+    {"r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476},
+    {"5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072},
+    {"3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711},
+    
+    // Promotion, stalemate and double check
+    {"2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001},
+    {"4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342},
+    {"8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683},
+    {"K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217},
+    {"8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584},
+    {"8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527},
+};
+
+int main() {
+    int failures = 0;
+    uint64_t total_nodes = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    
+    for (const PerftCase& test : CASES) {
+        Board board(test.fen);
+        uint64_t nodes = Perft::perft(board, test.depth);
+        total_nodes += nodes;
+        
+        // The threaded, hashed path must agree with the plain recursion
+        uint64_t parallel_nodes = Perft::parallel_perft(board, test.depth, 2, 16);
+        
+        bool passed = nodes == test.nodes && parallel_nodes == test.nodes;
+        if (!passed) failures++;
+        std::cout << (passed ? "PASS" : "FAIL") << "  depth " << test.depth << "  " << nodes;
+        if (!passed) std::cout << " / parallel " << parallel_nodes << " (expected " << test.nodes << ")";
+        std::cout << "  " << test.fen << "\n";
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "\n" << 2 * total_nodes << " nodes in " << uint64_t(seconds * 1000) << "ms ("
+              << uint64_t(2 * total_nodes / seconds) << " nps)\n";
+    std::cout << failures << " of " << (sizeof(CASES) / sizeof(CASES[0])) << " positions failed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+// Static exchange evaluation: known exchange values, including x-rays,
+// en passant and promotions
+#include "board.h"
+#include "eval.h"
+#include <iostream>
+
+struct SeeCase {
+    const char* fen;
+    const char* move;
+    int value;
+};
+
+static const SeeCase CASES[] = {
+    // Undefended pawn, then the same pawn with a rook x-ray behind the defender
+    {"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100},
+    {"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -220},
+    
+    // Queen takes a pawn defended by a pawn
+    {"4k3/8/2p5/3p4/8/8/8/3QK3 w - - 0 1", "d1d5", -800},
+    
+    // Equal trade, and a quiet move onto an attacked square
+    {"4k3/8/2p5/3n4/8/4N3/8/4K3 w - - 0 1", "e3d5", 0},
+    {"4k3/8/2p5/8/8/4N3/8/4K3 w - - 0 1", "e3d5", -320},
+    
+    // En passant, undefended and defended
+    {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 100},
+    {"4k3/2p5/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 0},
+    
+    // Promotion, undefended and defended
+    {"7k/P7/8/8/8/8/8/4K3 w - - 0 1", "a7a8q", 800},
+    {"1r5k/P7/8/8/8/8/8/4K3 w - - 0 1", "a7a8q", -100},
+    
+    // Promotion capture, undefended and defended
+    {"1r5k/P7/8/8/8/8/8/4K3 w - - 0 1", "a7b8q", 1300},
+    {"1r5k/P2n4/8/8/8/8/8/4K3 w - - 0 1", "a7b8q", 400},
+    
+    // Castling never wins or loses material
+    {"4k3/8/8/8/8/8/8/4K2R w K - 0 1", "e1g1", 0},
+};
+
+int main() {
+    int failures = 0;
+    for (const SeeCase& test : CASES) {
+        Board board(test.fen);
+        int value = Eval::see(board, board.parse_move(test.move));
+        bool passed = value == test.value;
+        if (!passed) failures++;
+        std::cout << (passed ? "PASS" : "FAIL") << "  " << test.move << "  " << value;
+        if (!passed) std::cout << " (expected " << test.value << ")";
+        std::cout << "  " << test.fen << "\n";
+    }
+    
+    std::cout << failures << " of " << (sizeof(CASES) / sizeof(CASES[0])) << " exchanges failed\n";
+    return failures == 0 ? 0 : 1;
+}